@@ -0,0 +1,361 @@
+// Move strategies compared on one seeded scenario library, with confidence intervals.
+//
+// Build: g++ -O2 -std=c++17 -Isdk_shim -I../Motor-Control ctrl_bench.cpp -o ctrl_bench
+// Usage: ctrl_bench [-n scenarios] [--seed s] [--variant n] [-j jobs] [-o runs.csv] [strategy...]
+//
+// Strategies are the firmware's own move functions, run in the firmware on the simulated winch
+// (sitl.h) with the parameter table's defaults for the variant:
+//   open    unwind_payload_m / wind_payload_m (move_meters, closed_loop 0)
+//   closed  the same after autotune_run on the nominal plant model (closed_loop 1, tuned gains,
+//           slew, brake and padding)
+//   eco     move_meters_eco (least-energy profile, no time budget) with the same tune
+// Every strategy runs every scenario, each in a fresh copy of the booted firmware. A scenario
+// draws, from --seed: distance, direction, cruise duty, payload (up to what takes 12 % duty to
+// hold; entered as payload_kg), a true plant that differs from the nominal one the controllers
+// were tuned on (gain, time constant, deadzone), and disturbances (dropped FG edges, a friction
+// bump, a supply sag). None of them jams the drum, so every stall is a false positive.
+// Per move: time until the drive's motion has settled, stop error (line then vs target), supply
+// energy, peak duty, and outcome. The summary gives the mean and 95 % confidence interval of each metric per strategy
+// over its completed moves, the paired difference to the first strategy listed over the moves
+// both completed (same scenarios, so the interval is much tighter than comparing means), and
+// stall / timeout rates with Wilson intervals.
+// To benchmark a new profile or controller, add its firmware call and a STRATEGIES entry.
+
+#include <algorithm>
+#include "sitl.h"
+
+static const float REST_PPS      = 0.5f;    // drum counts as stopped below this
+static const float REST_MAX_S    = 10.0f;   // longest wait for that after the move returns
+static const float Z95           = 1.96f;
+static const float PAYLOAD_MAX_PCT = 12.0f;  // heaviest payload, as duty to balance it
+
+struct Scenario {
+    float meters;
+    bool  lifting;
+    float cruise;
+    float payload_kg;
+    float gain_scale, tau_scale, deadzone_add;
+    float drop_p;                        // chance an FG edge is lost
+    float bump_t0, bump_s, bump_pct;     // friction bump: extra load duty over a window
+    float sag_t0, sag_s, sag_scale;      // supply sag: applied duty scaled over a window
+    uint32_t seed;
+};
+
+enum Outcome : uint8_t { OUT_OK, OUT_STALL, OUT_TIMEOUT };
+static const char* OUTCOME_NAMES[] = {"ok", "stall", "timeout"};
+
+struct RunOut {
+    Outcome outcome;
+    float   move_s;       // start to drum at rest
+    float   stop_err_m;   // signed, + past the target
+    float   energy_j;
+    float   peak_duty;
+};
+
+// ---- world: the true plant under the scenario's load and disturbances ----
+
+struct World {
+    const Scenario* sc;
+    PlantParams p;
+    MotorElec   elec;
+    float    rad_per_pulse;
+    float    speed_pps;   // line speed, + paying out
+    float    grav_pct;    // duty the payload takes, always pulling line out
+    double   t0;          // start of the move, s
+    uint32_t rng;
+    float    energy_j;
+    float    peak_duty;
+};
+
+static World g_world;
+
+static float frand(uint32_t& s) {
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    return (float)(s >> 8) / 16777216.0f;
+}
+
+// Steady-state line speed for a signed drive (+ paying out), t into the move
+static float world_ss_pps(const World& w, float drive, float t) {
+    const Scenario& sc = *w.sc;
+    float net = drive + w.grav_pct;
+    float fric = w.p.deadzone_pct;
+    if (t >= sc.bump_t0 && t < sc.bump_t0 + sc.bump_s) fric += sc.bump_pct;
+    float mag = fabsf(net) - fric;
+    return (mag > 0.0f) ? copysignf(w.p.gain_pps_per_pct * mag, net) : 0.0f;
+}
+
+// plant_step with a sign. The payload pulls the line out all the time, so a heavy one creeps out
+// at zero duty once it beats the deadzone (friction).
+static double world_step(void* ctx, float duty, bool dir_ccw, double t_s, double dt_s) {
+    World& w = *(World*)ctx;
+    const Scenario& sc = *w.sc;
+    const float dt = (float)dt_s;
+    float t = (float)(t_s - w.t0);
+    if (duty > w.peak_duty) w.peak_duty = duty;
+
+    float applied = duty;
+    if (t >= sc.sag_t0 && t < sc.sag_t0 + sc.sag_s) applied *= sc.sag_scale;
+
+    float ss = world_ss_pps(w, dir_ccw ? applied : -applied, t);
+    w.speed_pps += (ss - w.speed_pps) * dt / (w.p.tau_s + dt);
+
+    // supply power: applied voltage times armature current against the back-EMF
+    const MotorElec& e = w.elec;
+    float volts = e.supply_v * applied * 0.01f;
+    float drive_pps = dir_ccw ? w.speed_pps : -w.speed_pps;
+    float amps = (volts - e.ke * drive_pps * w.rad_per_pulse) / e.r_ohm;
+    if (volts * amps > 0.0f) w.energy_j += volts * amps * dt;
+    return w.speed_pps;
+}
+
+// FG has no direction: every pulse of travel either way is an edge, unless it is lost
+static uint32_t world_edges(void* ctx, double) {
+    World& w = *(World*)ctx;
+    return frand(w.rng) < w.sc->drop_p ? 0 : 1;
+}
+
+// ---- strategies ----
+
+struct Strategy {
+    const char* name;
+    bool tuned;                          // on the autotune result, else the defaults
+    bool (*move)(const Scenario& sc);
+};
+
+static bool move_bands(const Scenario& sc) {
+    return sc.lifting ? wind_payload_m(sc.meters, sc.cruise) : unwind_payload_m(sc.meters, sc.cruise);
+}
+
+static bool move_eco(const Scenario& sc) {
+    return move_meters_eco(sc.lifting, sc.meters);   // wind = CW
+}
+
+static const Strategy STRATEGIES[] = {
+    {"open",   false, move_bands},
+    {"closed", true,  move_bands},
+    {"eco",    true,  move_eco},
+};
+
+static ParamSet g_defaults, g_tuned;
+
+// In a fresh copy of the firmware: the strategy's parameters plus the payload, the scenario's
+// world, the move, then idle until the drive's own motion has died away. A payload heavy enough
+// to creep at zero duty keeps creeping, but that is the hold loop's job, not the move's.
+static void run_move(const Strategy& st, const Scenario& sc, RunOut& r) {
+    ParamSet& s = g_param_bank.staging;
+    s = st.tuned ? g_tuned : g_defaults;
+    s.payload_kg = sc.payload_kg;
+    s.line_loaded = 1;
+    params_commit_now();
+
+    World& w = g_world;
+    w.sc = &sc;
+    w.p = g_plant;
+    w.p.gain_pps_per_pct *= sc.gain_scale;
+    w.p.tau_s *= sc.tau_scale;
+    w.p.deadzone_pct += sc.deadzone_add;
+    w.elec = motor_elec_from(g_winch, g_plant);
+    w.rad_per_pulse = 2.0f * (float)M_PI / (float)g_winch.v->fg_pulses_per_motor_rev;
+    w.speed_pps = 0.0f;
+    w.grav_pct = fabsf(gravity_duty_pct(w.elec, sc.payload_kg, true));
+    w.rng = sc.seed | 1u;
+    w.energy_j = w.peak_duty = 0.0f;
+    g_sitl.world = {&w, world_step, world_edges, nullptr};
+
+    w.t0 = sitl_time_s();
+    double line0 = g_sitl.line_out;
+    uint32_t stalls0 = g_maint.c.stalls;
+    bool ok = st.move(sc);
+
+    double stop_t = sitl_time_s();
+    while ((g_slew.current > 0.0f ||
+            fabsf(w.speed_pps - world_ss_pps(w, 0.0f, (float)(sitl_time_s() - w.t0))) > REST_PPS) &&
+           sitl_time_s() - stop_t < REST_MAX_S) {
+        idle_ms(1);
+    }
+
+    double moved = (g_sitl.line_out - line0) * (sc.lifting ? -1.0 : 1.0);
+    r.outcome = ok ? OUT_OK : (g_maint.c.stalls != stalls0 ? OUT_STALL : OUT_TIMEOUT);
+    r.move_s = (float)(sitl_time_s() - w.t0);
+    r.stop_err_m = (float)(moved / g_winch.pulses_per_meter) - sc.meters;
+    r.energy_j = w.energy_j;
+    r.peak_duty = w.peak_duty;
+}
+
+// ---- scenario library ----
+
+static Scenario scenario_make(uint32_t seed, uint32_t i) {
+    uint32_t r = (seed * 2654435761u) ^ (i * 40503u + 0x9E3779B9u);
+    for (int k = 0; k < 4; k++) frand(r);
+    auto uni = [&](float lo, float hi) { return lo + (hi - lo) * frand(r); };
+
+    Scenario sc = {};
+    MotorElec elec = motor_elec_from(g_winch, g_plant);
+    float max_m = std::min(5.0f, 0.5f * g_winch.v->max_line_m);   // runs start with half the line out
+    sc.meters = expf(uni(logf(0.1f), logf(max_m)));          // log-uniform: short moves matter
+    sc.lifting = frand(r) < 0.5f;
+    sc.cruise = std::min(uni(40.0f, 100.0f), g_winch.v->max_duty_pct);
+    sc.payload_kg = uni(0.0f, 1.0f) * PAYLOAD_MAX_PCT / gravity_duty_pct(elec, 1.0f, true);
+    sc.gain_scale = uni(0.85f, 1.15f);
+    sc.tau_scale = uni(0.7f, 1.5f);
+    sc.deadzone_add = uni(-2.0f, 3.0f);
+    sc.drop_p = (frand(r) < 0.3f) ? uni(0.0f, 0.02f) : 0.0f;
+    sc.bump_t0 = sc.sag_t0 = 1e9f;
+    if (frand(r) < 0.3f) { sc.bump_t0 = uni(0.2f, 3.0f); sc.bump_s = uni(0.1f, 0.4f); sc.bump_pct = uni(5.0f, 15.0f); }
+    if (frand(r) < 0.2f) { sc.sag_t0 = uni(0.2f, 3.0f); sc.sag_s = uni(0.2f, 1.0f); sc.sag_scale = uni(0.7f, 0.95f); }
+    sc.seed = r;
+    return sc;
+}
+
+// ---- statistics ----
+
+struct Acc {
+    double n = 0, sum = 0, sum2 = 0;
+    void add(double x) { n++; sum += x; sum2 += x * x; }
+    double mean() const { return n > 0 ? sum / n : 0.0; }
+    double half_ci() const {
+        if (n < 2) return 0.0;
+        double var = (sum2 - sum * sum / n) / (n - 1);
+        return Z95 * sqrt(var > 0 ? var : 0) / sqrt(n);
+    }
+};
+
+// Wilson score interval for k of n
+static void wilson(uint32_t k, uint32_t n, double* lo, double* hi) {
+    if (n == 0) { *lo = *hi = 0.0; return; }
+    double p = (double)k / n, z = Z95, z2 = z * z;
+    double c = (p + z2 / (2 * n)) / (1 + z2 / n);
+    double h = z * sqrt(p * (1 - p) / n + z2 / (4.0 * n * n)) / (1 + z2 / n);
+    *lo = std::max(0.0, c - h);
+    *hi = std::min(1.0, c + h);
+}
+
+enum Metric { M_TIME, M_ERR, M_ENERGY, M_PEAK, METRIC_COUNT };
+static const char* METRIC_NAMES[METRIC_COUNT] = {"move_s", "|stop_err|_mm", "energy_J", "peak_duty_%"};
+
+static double metric(const RunOut& r, int m) {
+    switch (m) {
+        case M_TIME:   return r.move_s;
+        case M_ERR:    return fabs(r.stop_err_m) * 1000.0;
+        case M_ENERGY: return r.energy_j;
+        default:       return r.peak_duty;
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned jobs = (unsigned)sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t n = 500, seed = 1, variant = WINCH_VARIANT;
+    const char* csv_path = nullptr;
+    std::vector<const Strategy*> chosen;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) n = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--variant") == 0 && i + 1 < argc) variant = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) jobs = (unsigned)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) csv_path = argv[++i];
+        else {
+            const Strategy* found = nullptr;
+            for (const Strategy& s : STRATEGIES) {
+                if (strcmp(s.name, argv[i]) == 0) found = &s;
+            }
+            if (!found) {
+                fprintf(stderr, "usage: ctrl_bench [-n scenarios] [--seed s] [--variant n] [-j jobs] [-o runs.csv] [strategy...]\n"
+                                "strategies:");
+                for (const Strategy& s : STRATEGIES) fprintf(stderr, " %s", s.name);
+                fprintf(stderr, "\n");
+                return 2;
+            }
+            chosen.push_back(found);
+        }
+    }
+    if (chosen.empty()) {
+        for (const Strategy& s : STRATEGIES) chosen.push_back(&s);
+    }
+    if (variant >= WINCH_VARIANT_COUNT) {
+        fprintf(stderr, "no variant %u\n", (unsigned)variant);
+        return 2;
+    }
+    if (n == 0) n = 1;
+
+    // defaults as booted, then the firmware's own autotune on its nominal plant model
+    sitl_mute(true);
+    sitl_boot(variant);
+    g_defaults = params();
+    bool tuned = autotune_run(tune_default_spec(), /*identify=*/false);
+    g_tuned = params();
+    sitl_mute(false);
+    if (!tuned) fprintf(stderr, "warning: autotune rejected the nominal plant, tuned strategies run untuned\n");
+    g_sitl.line_out = 0.5 * g_winch.v->max_line_m * g_winch.pulses_per_meter;
+
+    std::vector<Scenario> scenarios(n);
+    for (uint32_t i = 0; i < n; i++) scenarios[i] = scenario_make(seed, i);
+
+    const size_t S = chosen.size();
+    std::vector<RunOut> runs(S * n);
+    std::vector<bool> done = sitl_fork_runs(runs, jobs, [&](size_t k, RunOut& r) {
+        run_move(*chosen[k / n], scenarios[k % n], r);
+    });
+    for (size_t k = 0; k < runs.size(); k++) {
+        if (!done[k]) {
+            fprintf(stderr, "scenario %zu, %s: the firmware run died\n", k % n, chosen[k / n]->name);
+            return 1;
+        }
+    }
+
+    if (csv_path) {
+        FILE* csv = fopen(csv_path, "w");
+        if (!csv) { fprintf(stderr, "cannot write %s\n", csv_path); return 1; }
+        fprintf(csv, "scenario,strategy,meters,lifting,cruise,payload_kg,outcome,move_s,stop_err_m,energy_j,peak_duty\n");
+        for (size_t k = 0; k < runs.size(); k++) {
+            const Scenario& sc = scenarios[k % n];
+            const RunOut& r = runs[k];
+            fprintf(csv, "%zu,%s,%.3f,%d,%.1f,%.2f,%s,%.3f,%.4f,%.2f,%.1f\n", k % n, chosen[k / n]->name,
+                    (double)sc.meters, sc.lifting ? 1 : 0, (double)sc.cruise, (double)sc.payload_kg,
+                    OUTCOME_NAMES[r.outcome], (double)r.move_s, (double)r.stop_err_m, (double)r.energy_j,
+                    (double)r.peak_duty);
+        }
+        fclose(csv);
+    }
+
+    printf("[BENCH] %u scenarios, seed %u, variant %s; defaults pad=%.3fm@%.0f%% slew=%.0f brake=%.0f\n",
+           (unsigned)n, (unsigned)seed, g_winch.v->name, (double)g_defaults.padding_m,
+           (double)g_defaults.padding_speed, (double)g_defaults.slew_rate, (double)g_defaults.brake_rate);
+    printf("[BENCH] tune %s (kp=%.4f ki=%.4f pos_kp=%.2f pad=%.3fm@%.0f%% slew=%.0f brake=%.0f)\n",
+           tuned ? "valid" : "REJECTED", (double)g_tuned.speed_kp, (double)g_tuned.speed_ki,
+           (double)g_tuned.pos_kp, (double)g_tuned.padding_m, (double)g_tuned.padding_speed,
+           (double)g_tuned.slew_rate, (double)g_tuned.brake_rate);
+    printf("%-8s %-14s %10s %23s   %s\n", "strategy", "metric", "mean", "95% CI", "paired vs first (95% CI)");
+
+    for (size_t s = 0; s < S; s++) {
+        const RunOut* rs = &runs[s * n];
+        const RunOut* base = &runs[0];
+
+        for (int m = 0; m < METRIC_COUNT; m++) {
+            Acc a, d;
+            for (uint32_t i = 0; i < n; i++) {
+                if (rs[i].outcome != OUT_OK) continue;
+                a.add(metric(rs[i], m));
+                if (s > 0 && base[i].outcome == OUT_OK) d.add(metric(rs[i], m) - metric(base[i], m));
+            }
+            printf("%-8s %-14s %10.3f   [%9.3f, %9.3f]", chosen[s]->name, METRIC_NAMES[m], a.mean(),
+                   a.mean() - a.half_ci(), a.mean() + a.half_ci());
+            if (s > 0) printf("   %+9.3f [%+.3f, %+.3f] n=%.0f", d.mean(), d.mean() - d.half_ci(), d.mean() + d.half_ci(), d.n);
+            printf("\n");
+        }
+
+        uint32_t stalls = 0, timeouts = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            stalls += rs[i].outcome == OUT_STALL;
+            timeouts += rs[i].outcome == OUT_TIMEOUT;
+        }
+        double lo, hi;
+        wilson(stalls, n, &lo, &hi);
+        printf("%-8s %-14s %9.2f%%   [%8.2f%%, %8.2f%%]   (%u of %u)\n", chosen[s]->name, "stall_fp",
+               100.0 * stalls / n, 100.0 * lo, 100.0 * hi, (unsigned)stalls, (unsigned)n);
+        wilson(timeouts, n, &lo, &hi);
+        printf("%-8s %-14s %9.2f%%   [%8.2f%%, %8.2f%%]   (%u of %u)\n", chosen[s]->name, "timeout",
+               100.0 * timeouts / n, 100.0 * lo, 100.0 * hi, (unsigned)timeouts, (unsigned)n);
+    }
+    return 0;
+}
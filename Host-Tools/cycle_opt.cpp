@@ -0,0 +1,441 @@
+// Cycle-time optimiser for the repeated unwind / hold / wind mission in main().
+//
+// Build: g++ -O2 -std=c++17 -Isdk_shim -I../Motor-Control cycle_opt.cpp -o cycle_opt
+// Usage: cycle_opt [-j jobs] [--variant n] [--meters m] [--hold s] [--payload kg] [--hold-torque]
+//                  [--stop-err m] [--max-mps m/s] [--t-max C] [--ambient C] [--rth K/W]
+//                  [--tau-th s] [-o params.txt]
+//
+// The mission is the firmware cycle: unwind_payload_m, hold_payload_ms, wind_payload_m, pause,
+// run in the firmware on the simulated winch (sitl.h). Everything not searched is the parameter
+// table's default for the variant, and so is the mission unless given: --meters cycle_m, --hold
+// cycle_hold_ms, --hold-torque hold_mode 1, --payload payload_kg. A payload that outweighs the
+// drive's friction creeps out at zero duty, so a hold that is to keep it in place needs
+// --hold-torque.
+// Each candidate profile (cruise duty, padding_m, padding_speed, slew_rate, brake_rate) goes in
+// through the staging set with closed_loop 0, and one cycle runs in a fresh copy of the booted
+// firmware. The world is the nominal plant with the payload's weight on the line; from it come
+// the busy time of the cycle, the stop error of each move (line at rest vs target), the peak line
+// speed and the winding loss over time (I = (gravity + friction + inertia torque) / Ke, as
+// energy_profile.h). The winding model is fleet_kpi's first-order one; its periodic steady state
+// over back-to-back cycles is solved in closed form, and the shortest pause that keeps its peak
+// under --t-max is found by bisection. Candidates that miss the stop accuracy or the line speed
+// limit, stall, time out, or are still driving when a move returns are dropped; the rest are
+// ranked by cycles per hour. A coarse grid is searched first, then a finer one around the best
+// point.
+// -o writes the winner as "param set" lines plus commit and save, to send over the command link.
+// The plant has no payload inertia or sag, so check the result on the winch.
+
+#include <algorithm>
+#include "sitl.h"
+
+static const float REST_PPS      = 0.5f;     // drum counts as stopped below this
+static const float REST_MAX_S    = 10.0f;    // longest wait for that after the wind returns
+static const float LOSS_BIN_S    = 0.05f;    // winding loss is integrated in bins this long
+static const float MAX_PAUSE_S   = 3600.0f;  // cycle_pause_ms upper bound
+static const uint32_t MAX_BINS   = 4096;     // longest cycle traced, in bins
+
+struct Mission {
+    float meters;
+    float hold_s;
+    float payload_kg;
+    bool  hold_torque;
+};
+
+struct Limits {
+    float stop_err_m;
+    float max_mps;
+    float t_max_c;
+    float ambient_c;
+    float rth_k_per_w;
+    float tau_s;
+};
+
+struct Cand {
+    float cruise;
+    float padding_m;
+    float padding_speed;
+    float slew_rate;
+    float brake_rate;
+};
+
+struct Eval {
+    bool  ok;
+    float busy_s;      // unwind + hold + wind, each move to the end of its brake settle
+    float pause_s;
+    float cycles_h;
+    float stop_err_m;  // worse of the two moves
+    float peak_mps;
+    float peak_c;      // steady-state winding peak at that pause
+};
+
+// What one cycle in the firmware gives: the winding loss in LOSS_BIN_S bins, without the pause
+struct CycleOut {
+    bool     ok;
+    float    busy_s;
+    float    stop_err_m;
+    float    peak_mps;
+    uint32_t bins;
+    float    w[MAX_BINS];
+};
+
+// ---- world: the nominal plant with the payload on the line ----
+
+static struct {
+    PlantParams p;
+    MotorElec   e;
+    float    rad_per_pulse;
+    float    grav_pct;    // duty the payload takes, always pulling line out
+    float    payload_kg;
+    float    speed_pps;   // line speed, + paying out
+    float    peak_pps;
+    float    acc_j, acc_t;
+    uint32_t bins;
+    float*   w;
+} g_world;
+
+static float world_ss_pps(float drive) {
+    float net = drive + g_world.grav_pct;
+    float mag = fabsf(net) - g_world.p.deadzone_pct;
+    return (mag > 0.0f) ? copysignf(g_world.p.gain_pps_per_pct * mag, net) : 0.0f;
+}
+
+// Motor current for the torque the drive delivers: the payload (against it when winding in),
+// friction while turning, and accelerating the rotor
+static float move_amps(float duty, float speed_pps, float acc_pps2, bool lifting) {
+    if (duty <= 0.0f) return 0.0f;
+    const MotorElec& e = g_world.e;
+    float t_grav = g_world.payload_kg * 9.81f * e.drum_r_m / e.gear_ratio * (lifting ? 1.0f : -1.0f);
+    float t_fric = (speed_pps > 0.0f) ? e.friction_nm : 0.0f;
+    float torque = t_grav + t_fric + e.j_kgm2 * acc_pps2 * g_world.rad_per_pulse;
+    return torque / e.ke;
+}
+
+static double world_step(void*, float duty, bool dir_ccw, double, double dt_s) {
+    const float dt = (float)dt_s;
+    float v0 = g_world.speed_pps;
+    float ss = world_ss_pps(dir_ccw ? duty : -duty);
+    g_world.speed_pps += (ss - g_world.speed_pps) * dt / (g_world.p.tau_s + dt);
+
+    // along the drive: + in the direction it turns the drum
+    float sign = dir_ccw ? 1.0f : -1.0f;
+    float amps = move_amps(duty, sign * g_world.speed_pps, sign * (g_world.speed_pps - v0) / dt, !dir_ccw);
+    g_world.acc_j += amps * amps * g_world.e.r_ohm * dt;
+    g_world.acc_t += dt;
+    if (g_world.acc_t >= LOSS_BIN_S) {
+        if (g_world.bins < MAX_BINS) g_world.w[g_world.bins++] = g_world.acc_j / g_world.acc_t;
+        g_world.acc_j = g_world.acc_t = 0.0f;
+    }
+    if (fabsf(g_world.speed_pps) > g_world.peak_pps) g_world.peak_pps = fabsf(g_world.speed_pps);
+    return g_world.speed_pps;
+}
+
+// ---- one cycle in the firmware ----
+
+static Mission g_mission;
+
+static float line_m() {
+    return (float)(g_sitl.line_out / g_winch.pulses_per_meter);
+}
+
+// In a fresh copy of the firmware: the candidate through the staging set, then unwind, hold and
+// wind as main() does. The stop error of the unwind is read at the end of the hold, which keeps
+// the payload there; the wind's once the drum has come to rest after it.
+static void run_cycle(const Cand& c, CycleOut& o) {
+    ParamSet& s = g_param_bank.staging;
+    s.closed_loop = 0;
+    s.gain_sched = 0;
+    s.padding_m = c.padding_m;
+    s.padding_speed = c.padding_speed;
+    s.slew_rate = c.slew_rate;
+    s.brake_rate = c.brake_rate;
+    s.hold_mode = g_mission.hold_torque ? 1 : 0;
+    s.payload_kg = g_mission.payload_kg;
+    s.line_loaded = 1;
+    params_commit_now();
+
+    g_world.speed_pps = g_world.peak_pps = 0.0f;
+    g_world.acc_j = g_world.acc_t = 0.0f;
+    g_world.bins = 0;
+    g_world.w = o.w;
+    g_sitl.world = {nullptr, world_step, nullptr, nullptr};
+    o.ok = false;
+
+    double t0 = sitl_time_s();
+    float line0 = line_m();
+    uint32_t hold_ms = (uint32_t)lroundf(g_mission.hold_s * 1000.0f);
+    if (!unwind_payload_m(g_mission.meters, c.cruise) || g_slew.current > 0.0f) return;
+    hold_payload_ms(hold_ms, /*tow_up_cw=*/true);
+    float err_down = line_m() - line0 - g_mission.meters;
+    float line1 = line_m();
+    if (!wind_payload_m(g_mission.meters, c.cruise) || g_slew.current > 0.0f) return;
+    o.busy_s = (float)(sitl_time_s() - t0);
+    if (g_world.acc_t > 0.0f && g_world.bins < MAX_BINS) g_world.w[g_world.bins++] = g_world.acc_j / g_world.acc_t;
+    o.bins = g_world.bins;
+    if (o.bins >= MAX_BINS) return;
+
+    double stop_t = sitl_time_s();
+    while (fabsf(g_world.speed_pps - world_ss_pps(0.0f)) > REST_PPS && sitl_time_s() - stop_t < REST_MAX_S) {
+        idle_ms(1);
+    }
+    float err_up = line1 - line_m() - g_mission.meters;
+
+    o.ok = true;
+    o.stop_err_m = std::max(fabsf(err_down), fabsf(err_up));
+    o.peak_mps = g_world.peak_pps / g_winch.pulses_per_meter;
+}
+
+// Peak winding temperature in the periodic steady state of back-to-back cycles with this pause.
+// Each bin is exact for a constant loss: T += (T_ss - T) * (1 - exp(-dt / tau)).
+static float steady_peak_c(const Limits& l, const CycleOut& o, float pause_s) {
+    float k_bin = 1.0f - expf(-LOSS_BIN_S / l.tau_s);
+    float k_pause = 1.0f - expf(-pause_s / l.tau_s);
+
+    // one cycle maps T0 to A * T0 + B; run it from T0 = 0 to get B, A is the product of decays
+    float a = 1.0f, b = 0.0f;
+    for (uint32_t i = 0; i < o.bins; i++) {
+        b += (l.ambient_c + o.w[i] * l.rth_k_per_w - b) * k_bin;
+        a *= 1.0f - k_bin;
+    }
+    b += (l.ambient_c - b) * k_pause;
+    a *= 1.0f - k_pause;
+
+    float temp = (a < 1.0f) ? b / (1.0f - a) : l.ambient_c;
+    float peak = temp;
+    for (uint32_t i = 0; i < o.bins; i++) {
+        temp += (l.ambient_c + o.w[i] * l.rth_k_per_w - temp) * k_bin;
+        if (temp > peak) peak = temp;
+    }
+    return peak;
+}
+
+static Eval evaluate(const Limits& lim, const CycleOut& o) {
+    Eval ev = {false, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    if (!o.ok) return ev;
+
+    ev.busy_s = o.busy_s;
+    ev.stop_err_m = o.stop_err_m;
+    ev.peak_mps = o.peak_mps;
+    if (ev.stop_err_m > lim.stop_err_m || ev.peak_mps > lim.max_mps) return ev;
+
+    // shortest pause that keeps the winding under the limit (peak falls as the pause grows)
+    float lo = 0.0f, hi = MAX_PAUSE_S;
+    if (steady_peak_c(lim, o, hi) > lim.t_max_c) return ev;
+    if (steady_peak_c(lim, o, lo) > lim.t_max_c) {
+        while (hi - lo > 0.01f) {
+            float mid = 0.5f * (lo + hi);
+            if (steady_peak_c(lim, o, mid) > lim.t_max_c) lo = mid;
+            else hi = mid;
+        }
+        lo = ceilf(hi * 1000.0f) / 1000.0f;   // whole ms, rounded up
+    }
+
+    ev.ok = true;
+    ev.pause_s = lo;
+    ev.peak_c = steady_peak_c(lim, o, lo);
+    ev.cycles_h = 3600.0f / (ev.busy_s + ev.pause_s);
+    return ev;
+}
+
+// All combinations of the per-dimension value lists
+static std::vector<Cand> grid(const std::vector<float> (&v)[5]) {
+    std::vector<Cand> out;
+    for (float a : v[0]) for (float b : v[1]) for (float c : v[2]) for (float d : v[3]) for (float e : v[4]) {
+        out.push_back({a, b, c, d, e});
+    }
+    return out;
+}
+
+// Every candidate's cycle in its own copy of the firmware, jobs at a time; the thermal pause
+// search runs here on what each returns
+static std::vector<Eval> run_all(const Limits& lim, const std::vector<Cand>& cands, unsigned jobs) {
+    std::vector<CycleOut> outs(cands.size());
+    std::vector<bool> done = sitl_fork_runs(outs, jobs, [&](size_t i, CycleOut& o) { run_cycle(cands[i], o); });
+    std::vector<Eval> evs(cands.size());
+    for (size_t i = 0; i < cands.size(); i++) {
+        if (done[i]) evs[i] = evaluate(lim, outs[i]);
+        else evs[i] = {false, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    }
+    return evs;
+}
+
+static void search(const Limits& lim, const std::vector<Cand>& cands, unsigned jobs,
+                   Cand& best, Eval& best_ev, uint32_t& feasible) {
+    std::vector<Eval> evs = run_all(lim, cands, jobs);
+    for (size_t i = 0; i < cands.size(); i++) {
+        if (!evs[i].ok) continue;
+        feasible++;
+        // ties (same rate) go to the smaller stop error
+        if (!best_ev.ok || evs[i].cycles_h > best_ev.cycles_h * 1.0001f ||
+            (evs[i].cycles_h > best_ev.cycles_h * 0.9999f && evs[i].stop_err_m < best_ev.stop_err_m)) {
+            best = cands[i];
+            best_ev = evs[i];
+        }
+    }
+}
+
+// Three values spaced step apart around x, kept inside [lo, hi]
+static std::vector<float> around(float x, float step, float lo, float hi) {
+    std::vector<float> v;
+    for (int k = -1; k <= 1; k++) {
+        float y = x + (float)k * step;
+        if (y >= lo && y <= hi) v.push_back(y);
+    }
+    return v;
+}
+
+static std::vector<float> range_list(float lo, float hi, float step) {
+    std::vector<float> v;
+    for (float x = lo; x <= hi + 1e-4f; x += step) v.push_back(x);
+    return v;
+}
+
+static void print_eval(const char* tag, const Cand& c, const Eval& ev) {
+    printf("[%s] cruise=%.0f%% padding_m=%.3f padding_speed=%.0f%% slew=%.0f brake=%.0f -> "
+           "busy=%.2fs pause=%.2fs %.1f cycles/h stop_err=%.1fmm peak=%.2fm/s winding=%.1fC\n",
+           tag, (double)c.cruise, (double)c.padding_m, (double)c.padding_speed, (double)c.slew_rate,
+           (double)c.brake_rate, (double)ev.busy_s, (double)ev.pause_s, (double)ev.cycles_h,
+           (double)(ev.stop_err_m * 1000.0f), (double)ev.peak_mps, (double)ev.peak_c);
+}
+
+int main(int argc, char** argv) {
+    unsigned jobs = (unsigned)sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t variant = WINCH_VARIANT;
+    const char* out_path = nullptr;
+    float meters = -1.0f, hold_s = -1.0f, payload_kg = -1.0f;
+    bool hold_torque = false;
+    Limits lim = {0.05f, 0.0f, 120.0f, 25.0f, 6.0f, 900.0f};
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) jobs = (unsigned)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--variant") == 0 && i + 1 < argc) variant = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--meters") == 0 && i + 1 < argc) meters = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--hold") == 0 && i + 1 < argc) hold_s = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--payload") == 0 && i + 1 < argc) payload_kg = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--hold-torque") == 0) hold_torque = true;
+        else if (strcmp(argv[i], "--stop-err") == 0 && i + 1 < argc) lim.stop_err_m = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--max-mps") == 0 && i + 1 < argc) lim.max_mps = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--t-max") == 0 && i + 1 < argc) lim.t_max_c = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--ambient") == 0 && i + 1 < argc) lim.ambient_c = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--rth") == 0 && i + 1 < argc) lim.rth_k_per_w = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--tau-th") == 0 && i + 1 < argc) lim.tau_s = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) out_path = argv[++i];
+        else {
+            fprintf(stderr, "usage: cycle_opt [-j jobs] [--variant n] [--meters m] [--hold s] [--payload kg]\n"
+                            "                 [--hold-torque] [--stop-err m] [--max-mps m/s] [--t-max C]\n"
+                            "                 [--ambient C] [--rth K/W] [--tau-th s] [-o params.txt]\n");
+            return 2;
+        }
+    }
+    if (variant >= WINCH_VARIANT_COUNT) {
+        fprintf(stderr, "no variant %u\n", (unsigned)variant);
+        return 2;
+    }
+
+    sitl_mute(true);
+    sitl_boot(variant);
+    sitl_mute(false);
+    const ParamSet def_ps = params();
+
+    // the mission: as given, else the cycle_* parameters as booted
+    Mission& m = g_mission;
+    m.meters = (meters >= 0.0f) ? meters : def_ps.cycle_m;
+    m.hold_s = (hold_s >= 0.0f) ? hold_s : (float)def_ps.cycle_hold_ms * 1e-3f;
+    m.payload_kg = (payload_kg >= 0.0f) ? payload_kg : def_ps.payload_kg;
+    m.hold_torque = hold_torque || def_ps.hold_mode == 1;
+    if (!(m.meters > 0.0f) || m.meters > g_winch.v->max_line_m || !(m.hold_s >= 0.0f) ||
+        !(lim.stop_err_m > 0.0f) || !(lim.tau_s > 0.0f) || !(lim.t_max_c > lim.ambient_c)) {
+        fprintf(stderr, "bad mission or limits (meters up to %.1f for this variant)\n", (double)g_winch.v->max_line_m);
+        return 2;
+    }
+    if (!(lim.max_mps > 0.0f)) lim.max_mps = g_winch.max_line_speed_mps;
+
+    g_world.p = g_plant;
+    g_world.e = motor_elec_from(g_winch, g_plant);
+    g_world.rad_per_pulse = 2.0f * (float)M_PI / (float)g_winch.v->fg_pulses_per_motor_rev;
+    g_world.payload_kg = m.payload_kg;
+    g_world.grav_pct = fabsf(gravity_duty_pct(g_world.e, m.payload_kg, true));
+    // cycles start wound in by half the line the move leaves spare, so neither end is reached
+    g_sitl.line_out = 0.5 * (g_winch.v->max_line_m - m.meters) * g_winch.pulses_per_meter;
+
+    printf("[OPT] variant %s: %.2f m, hold %.1f s (%s), payload %.2f kg; stop_err<=%.0fmm, "
+           "line<=%.2fm/s, winding<=%.0fC\n",
+           g_winch.v->name, (double)m.meters, (double)m.hold_s, m.hold_torque ? "torque" : "zero duty",
+           (double)m.payload_kg, (double)(lim.stop_err_m * 1000.0f), (double)lim.max_mps,
+           (double)lim.t_max_c);
+
+    // the parameter table's defaults as the reference point
+    Cand def = {std::min(def_ps.cycle_speed, g_winch.v->max_duty_pct), def_ps.padding_m, def_ps.padding_speed,
+                def_ps.slew_rate, def_ps.brake_rate};
+    Eval def_ev = run_all(lim, {def}, 1)[0];
+    if (def_ev.ok) print_eval("DEFAULT", def, def_ev);
+    else if (def_ev.busy_s > 0.0f) {
+        printf("[DEFAULT] defaults miss the limits: stop_err=%.1fmm peak=%.2fm/s\n",
+               (double)(def_ev.stop_err_m * 1000.0f), (double)def_ev.peak_mps);
+    } else printf("[DEFAULT] defaults do not complete the cycle\n");
+
+    // coarse grid inside the parameter bounds and the variant's duty cap
+    float max_duty = g_winch.v->max_duty_pct;
+    std::vector<float> coarse[5] = {
+        range_list(20.0f, max_duty, 20.0f),
+        {0.0f, 0.05f, 0.1f, 0.2f, 0.4f},
+        range_list(20.0f, 100.0f, 20.0f),
+        {100.0f, 200.0f, 400.0f, 800.0f, 1600.0f},
+        {200.0f, 400.0f, 800.0f, 1600.0f, 3200.0f},
+    };
+    if (coarse[0].empty() || coarse[0].back() < max_duty) coarse[0].push_back(max_duty);
+
+    Cand best = def;
+    Eval best_ev = {false, 0, 0, 0, 0, 0, 0};
+    uint32_t feasible = 0;
+    std::vector<Cand> cands = grid(coarse);
+    search(lim, cands, jobs, best, best_ev, feasible);
+    printf("[OPT] coarse: %zu candidates, %u feasible\n", cands.size(), (unsigned)feasible);
+    if (!best_ev.ok) {
+        printf("[OPT] no feasible profile: relax --stop-err, --max-mps or --t-max\n");
+        return 1;
+    }
+
+    // finer grid around the coarse winner; multiplicative steps for the rates
+    std::vector<float> fine[5] = {
+        around(best.cruise, 5.0f, 1.0f, max_duty),
+        around(best.padding_m, 0.025f, 0.0f, 5.0f),
+        around(best.padding_speed, 5.0f, 1.0f, 100.0f),
+        {best.slew_rate / 1.41f, best.slew_rate, best.slew_rate * 1.41f},
+        {best.brake_rate / 1.41f, best.brake_rate, best.brake_rate * 1.41f},
+    };
+    for (int d = 3; d < 5; d++) {
+        for (float& r : fine[d]) r = std::min(5000.0f, std::max(1.0f, roundf(r)));
+    }
+    feasible = 0;
+    cands = grid(fine);
+    search(lim, cands, jobs, best, best_ev, feasible);
+    printf("[OPT] fine: %zu candidates, %u feasible\n", cands.size(), (unsigned)feasible);
+
+    print_eval("BEST", best, best_ev);
+    if (def_ev.ok) {
+        printf("[OPT] %+.1f%% cycles/h over the defaults\n",
+               (double)((best_ev.cycles_h / def_ev.cycles_h - 1.0f) * 100.0f));
+    }
+
+    if (out_path) {
+        FILE* f = fopen(out_path, "w");
+        if (!f) { fprintf(stderr, "cannot write %s\n", out_path); return 1; }
+        fprintf(f, "param set closed_loop 0\n");
+        fprintf(f, "param set gain_sched 0\n");
+        fprintf(f, "param set padding_m %.4f\n", (double)best.padding_m);
+        fprintf(f, "param set padding_speed %.1f\n", (double)best.padding_speed);
+        fprintf(f, "param set slew_rate %.0f\n", (double)best.slew_rate);
+        fprintf(f, "param set brake_rate %.0f\n", (double)best.brake_rate);
+        fprintf(f, "param set cycle_m %.4f\n", (double)m.meters);
+        fprintf(f, "param set cycle_hold_ms %u\n", (unsigned)lroundf(m.hold_s * 1000.0f));
+        fprintf(f, "param set cycle_speed %.1f\n", (double)best.cruise);
+        fprintf(f, "param set cycle_pause_ms %u\n", (unsigned)lroundf(best_ev.pause_s * 1000.0f));
+        fprintf(f, "param set hold_mode %u\n", m.hold_torque ? 1u : 0u);
+        fprintf(f, "param set payload_kg %.3f\n", (double)m.payload_kg);
+        fprintf(f, "param commit\n");
+        fprintf(f, "param save\n");
+        fclose(f);
+        printf("[OPT] wrote %s\n", out_path);
+    }
+    return 0;
+}
@@ -0,0 +1,476 @@
+// Fault injection for move_meters and hold_payload_ms against the winch plant.
+//
+// Build: g++ -O2 -std=c++17 -Isdk_shim -I../Motor-Control fault_sim.cpp -o fault_sim
+// Usage: fault_sim [-j jobs] [runs] [scenario]
+//
+// A fault layer sits between the firmware and the plant and, at scripted times, drops or
+// duplicates FG edges, adds spurious edges, jams the drum, sags the supply, delays PWM updates,
+// lets the payload slip or pulls harder on a payload held with torque. The controllers are the
+// firmware's own unwind_payload_m and hold_payload_ms, run in the firmware on the simulated
+// winch (sitl.h) with the parameter table's defaults, each run in a fresh copy of the booted
+// firmware. Each scenario runs with
+// the fault onset spread over its window and asserts the outcome and, where the controller has
+// to react, the worst reaction latency (fault onset to the stall / timeout / nudge counter
+// moving) and the line error; a torque hold also its peak slip under the pull and how long after
+// the onset it is back in band. The thresholds are derived from the parameters and the plant
+// model (see scenario_bounds) and printed with the results. Exit code 1 if any scenario fails.
+
+#include "sitl.h"
+
+static const float REST_PPS   = 0.5f;    // drum counts as stopped below this
+static const float P_MISS     = 1e-4f;   // accepted chance of a run of lost edges outlasting a bound
+static const float Z_MISS     = 3.72f;   // one-sided normal quantile of P_MISS
+static const float HOLD_BAND_PULSES = 2.0f;   // a torque hold has settled inside this (clean count)
+
+enum FaultKind { F_NONE, F_DROP, F_DUP, F_NOISE, F_FREEZE, F_SAG, F_PWM_DELAY, F_SLIP, F_LOAD };
+
+static const char* FAULT_NAMES[] = {"none", "drop", "dup", "noise", "freeze", "sag", "pwm_delay", "slip", "load"};
+
+struct Fault {
+    FaultKind kind;
+    float     dur_s;     // from onset; 0 = to the end
+    float     mag;       // drop/dup: probability; noise: edges/s; sag: supply left (0..1);
+                         // pwm_delay: s; slip: payload creep, pulses/s; load: extra pull on
+                         // the line, as the duty that balances it
+};
+
+enum Outcome { OUT_OK, OUT_STALL, OUT_TIMEOUT, OUT_NUDGE };
+
+static const char* OUTCOME_NAMES[] = {"ok", "stall", "timeout", "nudge"};
+
+static constexpr uint32_t SCN_FAULTS = 2;
+
+struct Scenario {
+    const char* name;
+    bool        hold;            // else a move (unwind)
+    float       meters;          // move distance / hold time (s)
+    float       speed_pct;
+    float       load_pct;        // payload, as the duty that balances it; > 0 holds with torque
+    float       onset_min_s, onset_max_s;
+    Fault       faults[SCN_FAULTS];
+    Outcome     expect;
+};
+
+// ---- Plant behind the fault layer ----
+
+struct World {
+    PlantParams p;
+    PlantState  s;
+    float       load_pct;       // payload pull; the drum then runs on the signed model below
+    float       speed_pps;      // signed, + paying out (payload runs only)
+    double      t0;             // start of the run, s
+    float       onset;          // s into the run
+    const Fault* faults;
+    uint32_t    seed;
+    std::deque<std::pair<double, float>> pwm;   // (time, duty) history, for the delay line
+
+    // first time the firmware's stall / timeout / nudge counters moved
+    uint32_t    stalls0, timeouts0, nudges0;
+    double      react_t;
+
+    // payload runs, up to the end of the hold: line paid out from the start, its peak, the last
+    // time it was outside band_pulses and where it ended
+    double      line0;
+    double      hold_s;
+    float       band_pulses;
+    double      peak_pulses;
+    double      out_t;
+    double      held_pulses;
+};
+
+static World g_world;
+
+static float frand(uint32_t& s) {
+    s = s * 1664525u + 1013904223u;
+    return (float)(s >> 8) / 16777216.0f;
+}
+
+static const Fault* fault_active(const World& w, double t_s, FaultKind k) {
+    float t = (float)(t_s - w.t0);
+    for (uint32_t i = 0; i < SCN_FAULTS; i++) {
+        const Fault& f = w.faults[i];
+        if (f.kind != k || t < w.onset) continue;
+        if (f.dur_s > 0.0f && t >= w.onset + f.dur_s) continue;
+        return &f;
+    }
+    return nullptr;
+}
+
+static double world_step(void* ctx, float duty, bool dir_ccw, double t_s, double dt_s) {
+    World& w = *(World*)ctx;
+
+    if (w.react_t < 0.0 && (g_maint.c.stalls != w.stalls0 || g_maint.c.timeouts != w.timeouts0 ||
+                            g_maint.c.nudges != w.nudges0)) {
+        w.react_t = t_s - w.t0;
+    }
+
+    w.pwm.push_back({t_s, duty});
+    if (const Fault* f = fault_active(w, t_s, F_PWM_DELAY)) {
+        while (w.pwm.size() > 1 && w.pwm[1].first <= t_s - f->mag) w.pwm.pop_front();
+        duty = (w.pwm.front().first <= t_s - f->mag) ? w.pwm.front().second : 0.0f;
+    } else {
+        while (w.pwm.size() > 1) w.pwm.pop_front();
+    }
+    if (const Fault* f = fault_active(w, t_s, F_SAG)) duty *= f->mag;
+
+    double v = 0.0;
+    if (fault_active(w, t_s, F_FREEZE)) {
+        w.s.speed_pps = 0.0f;
+        w.speed_pps = 0.0f;
+    } else if (w.load_pct > 0.0f) {
+        // the payload pulls the line out all the time; the drive has to beat it and friction
+        float load = w.load_pct;
+        if (const Fault* f = fault_active(w, t_s, F_LOAD)) load += f->mag;
+        float net = (dir_ccw ? duty : -duty) + load;
+        float mag = fabsf(net) - w.p.deadzone_pct;
+        float ss = (mag > 0.0f) ? copysignf(w.p.gain_pps_per_pct * mag, net) : 0.0f;
+        w.speed_pps += (ss - w.speed_pps) * (float)dt_s / (w.p.tau_s + (float)dt_s);
+        v = w.speed_pps;
+
+        if (t_s - w.t0 <= w.hold_s) {
+            w.held_pulses = g_sitl.line_out - w.line0;
+            double out = fabs(w.held_pulses);
+            if (out > w.peak_pulses) w.peak_pulses = out;
+            if (out > w.band_pulses) w.out_t = t_s - w.t0;
+        }
+    } else {
+        plant_step(w.s, w.p, duty, (float)dt_s);
+        v = dir_ccw ? w.s.speed_pps : -w.s.speed_pps;
+    }
+
+    // payload creeping down against a stopped drum
+    if (const Fault* f = fault_active(w, t_s, F_SLIP)) v += f->mag;
+    return v;
+}
+
+static uint32_t world_edges(void* ctx, double t_s) {
+    World& w = *(World*)ctx;
+    const Fault* drop = fault_active(w, t_s, F_DROP);
+    if (drop && frand(w.seed) < drop->mag) return 0;
+    const Fault* dup = fault_active(w, t_s, F_DUP);
+    return (dup && frand(w.seed) < dup->mag) ? 2 : 1;
+}
+
+static uint32_t world_noise(void* ctx, double t_s, double dt_s) {
+    World& w = *(World*)ctx;
+    const Fault* f = fault_active(w, t_s, F_NOISE);
+    return (f && frand(w.seed) < f->mag * (float)dt_s) ? 1 : 0;
+}
+
+struct RunResult {
+    Outcome outcome;
+    float   react_t;      // first reaction, -1 = none
+    float   line_err_m;   // true line out vs intended
+    float   peak_m;       // payload runs: furthest the line got from where the hold started
+    float   out_t;        // payload runs: last time it was outside the band, s into the run
+};
+
+// In a fresh copy of the firmware: the faulted world, then the firmware's unwind or hold
+static void run_one(const Scenario& sc, float onset, float band_pulses, uint32_t seed, RunResult& r) {
+    World& w = g_world;
+    w.p = g_plant;
+    w.s = {0.0f, 0.0f};
+    w.load_pct = sc.load_pct;
+    w.speed_pps = 0.0f;
+    w.onset = onset;
+    w.faults = sc.faults;
+    w.seed = seed;
+    w.stalls0 = g_maint.c.stalls;
+    w.timeouts0 = g_maint.c.timeouts;
+    w.nudges0 = g_maint.c.nudges;
+    w.react_t = -1.0;
+    g_sitl.world = {&w, world_step, world_edges, world_noise};
+
+    // a payload is held with torque, its weight known
+    if (sc.load_pct > 0.0f) {
+        ParamSet& ps = g_param_bank.staging;
+        ps.hold_mode = 1;
+        ps.payload_kg = sc.load_pct / gravity_duty_pct(motor_elec_from(g_winch, g_plant), 1.0f, true);
+        params_commit_now();
+    }
+
+    w.t0 = sitl_time_s();
+    double line0 = g_sitl.line_out;
+    w.line0 = line0;
+    w.hold_s = sc.hold ? sc.meters : 0.0;
+    w.band_pulses = band_pulses;
+    w.peak_pulses = 0.0;
+    w.out_t = 0.0;
+    w.held_pulses = 0.0;
+    bool ok;
+    if (sc.hold) {
+        ok = hold_payload_ms((uint32_t)(sc.meters * 1000.0f), /*tow_up_cw=*/true);
+    } else {
+        ok = unwind_payload_m(sc.meters, sc.speed_pct);
+        // the line error is where the drum comes to rest
+        double stop_t = sitl_time_s();
+        while (fabsf(w.s.speed_pps) > REST_PPS && sitl_time_s() - stop_t < 2.0) idle_ms(1);
+    }
+    sitl_advance();   // let the world see the last counter change
+
+    float moved = (float)((g_sitl.line_out - line0) / g_winch.pulses_per_meter);
+    r.react_t = (float)w.react_t;
+    r.peak_m = (float)(w.peak_pulses / g_winch.pulses_per_meter);
+    r.out_t = (float)w.out_t;
+    r.line_err_m = sc.hold ? moved : moved - sc.meters;
+    // the torque hold ramps its duty off at the end and lets the payload down a little by design:
+    // judge where it held
+    if (sc.load_pct > 0.0f) r.line_err_m = (float)(w.held_pulses / g_winch.pulses_per_meter);
+    if (g_maint.c.stalls != w.stalls0) r.outcome = OUT_STALL;
+    else if (g_maint.c.timeouts != w.timeouts0) r.outcome = OUT_TIMEOUT;
+    else if (g_maint.c.nudges != w.nudges0) r.outcome = OUT_NUDGE;
+    else r.outcome = ok ? OUT_OK : OUT_TIMEOUT;
+}
+
+static const Scenario SCENARIOS[] = {
+    // name               hold   m/s    speed  load   onset window  faults                                             expect
+    {"clean",             false, 2.0f,  40.0f, 0.0f, 0.5f, 0.5f, {{F_NONE, 0, 0}},                                     OUT_OK},
+    {"jam",               false, 2.0f,  40.0f, 0.0f, 0.5f, 3.0f, {{F_FREEZE, 0, 0}},                                   OUT_STALL},
+    {"brownout",          false, 2.0f,  40.0f, 0.0f, 0.5f, 3.0f, {{F_SAG, 0, 0.1f}},                                   OUT_STALL},
+    {"sag_60",            false, 2.0f,  40.0f, 0.0f, 0.5f, 3.0f, {{F_SAG, 0, 0.6f}},                                   OUT_OK},
+    {"pwm_delay_100ms",   false, 2.0f,  40.0f, 0.0f, 0.5f, 3.0f, {{F_PWM_DELAY, 0, 0.1f}},                             OUT_OK},
+    {"drop_10",           false, 2.0f,  40.0f, 0.0f, 0.5f, 3.0f, {{F_DROP, 0, 0.1f}},                                  OUT_OK},
+    {"dup_10",            false, 2.0f,  40.0f, 0.0f, 0.5f, 3.0f, {{F_DUP, 0, 0.1f}},                                   OUT_OK},
+    {"noise_20hz",        false, 2.0f,  40.0f, 0.0f, 0.5f, 3.0f, {{F_NOISE, 0, 20.0f}},                                OUT_OK},
+    {"jam_noise",         false, 2.0f,  40.0f, 0.0f, 0.5f, 3.0f, {{F_FREEZE, 0, 0}, {F_NOISE, 0, 20.0f}},              OUT_STALL},
+    {"hold_slip",         true,  10.0f, 0.0f,  0.0f,  1.0f, 6.0f, {{F_SLIP, 0.5f, 40.0f}},                              OUT_NUDGE},
+    {"hold_slip_drop",    true,  10.0f, 0.0f,  0.0f,  1.0f, 6.0f, {{F_SLIP, 0.5f, 40.0f}, {F_DROP, 0, 0.5f}},            OUT_NUDGE},
+    {"hold_slip_pwm",     true,  10.0f, 0.0f,  0.0f,  1.0f, 6.0f, {{F_SLIP, 0.5f, 40.0f}, {F_PWM_DELAY, 0, 0.1f}},       OUT_NUDGE},
+    {"hold_torque_gust",  true,  20.0f, 0.0f,  12.0f, 1.0f, 4.0f, {{F_LOAD, 1.0f, 8.0f}},                              OUT_OK},
+    {"hold_torque_drop",  true,  20.0f, 0.0f,  12.0f, 1.0f, 4.0f, {{F_LOAD, 1.0f, 8.0f}, {F_DROP, 0, 0.1f}},           OUT_OK},
+};
+
+static constexpr uint32_t SCENARIO_COUNT = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+
+// Edges the world has to raise for k of them to be counted, when each is lost with chance p,
+// except with chance P_MISS (binomial tail)
+static uint32_t edges_for_counted(uint32_t k, float p) {
+    if (p <= 0.0f) return k;
+    for (uint32_t n = k;; n++) {
+        // chance of fewer than k counted in n
+        double tail = 0.0, term = pow((double)p, (double)n);   // j = 0
+        for (uint32_t j = 0; j < k; j++) {
+            tail += term;
+            term *= (double)(n - j) / (double)(j + 1) * (1.0 - p) / p;
+        }
+        if (tail < P_MISS) return n;
+    }
+}
+
+// Edges lost on the way to k counted, each lost with chance p, except with chance P_MISS.
+// Negative binomial, mean k p / (1 - p) and variance k p / (1 - p)^2; for the hundreds of edges
+// of a move the normal tail is close and the exact sum above underflows.
+static float edges_lost_max(float k, float p) {
+    if (p <= 0.0f) return 0.0f;
+    return (k * p + Z_MISS * sqrtf(k * p)) / (1.0f - p);
+}
+
+struct Bounds {
+    float latency_s;    // 0 = no reaction expected
+    float line_err_m;   // 0 = not checked
+    float peak_m;       // payload runs: furthest the line may get, 0 = not checked
+    float settle_s;     // payload runs: back inside band_pulses this long after the onset
+    float band_pulses;
+};
+
+// Pass thresholds from the parameters as booted and the nominal plant. A move of the defaults
+// ends at padding_speed, so a clean one overshoots by the brake coast from there
+// (tune_brake_distance_pulses) plus a pulse of count quantisation. Each fault adds what it
+// can cost at most:
+//   drop p       every lost edge is line the count misses past the target: meters * p / (1 - p)
+//                on average, edges_lost_max of them at worst
+//   dup p        every doubled one ends the move early: meters * p / (1 + p) short of it
+//   noise r      spurious edges over the longest the move can take (all of it at padding speed)
+//   pwm_delay d  the stop reaches the drive d late, at padding speed
+//   sag          a weaker drive only coasts less
+//   freeze       the stall window holding the onset can still pass, the next whole one can't:
+//                2 windows, plus a spin of the move loop
+//   sag to stall as freeze, plus 3 tau for the drum to spin down (95 %)
+// Every latency also allows a step of the simulated clock (edges land on its ticks) and two spins
+// of the firmware's wait loop.
+// A hold reacts to the deadband + 1st edge, which slip at rate r raises within (deadband + 1) / r
+// (edges_for_counted of them when edges are lost). FG has no direction, so slip that goes on
+// while a nudge runs and brakes reads as the nudge's own travel and is dropped with its count:
+// all of the slip after that first reaction may be left, on top of the deadband + 1 pulses and
+// the coast of a nudge at its slowest. That is more than the slip itself, so it does not catch a
+// hold that stays put (the outcome and latency do), only one that nudges the wrong way or
+// overshoots. Faults add:
+//   drop p       a nudge counts its run short and travels 1 / (1 - p) of it: slip * p / (1 - p)
+//   pwm_delay d  the nudge's stop reaches the drive d late, at nudge speed
+// A torque hold takes an extra pull dL (as duty) on its P term: the line stops within dL / kp,
+// plus dz / kp if the first guess at the direction was wrong and the duty moved a friction's
+// worth the wrong way before it was caught, plus what the drum covers at K dL over a loop step
+// and tau. Once the pull is gone the drum sticks until the integrator has moved the duty across
+// the friction band (2 dz, at ki per pulse of error outside the band), then closes at the slow
+// root of s^2 + K kp s + K ki (4 time constants), after the settle the direction latch waits.
+// Lost edges make the count short by p / (1 - p) on the way out, and the way back doesn't undo
+// it exactly: the band widens by that much of the peak, each way.
+static Bounds scenario_bounds(const Scenario& sc) {
+    const ParamSet& ps = params();
+    const float ppm = g_winch.pulses_per_meter;
+    const float window_s = (float)ps.stall_window_us * 1e-6f;
+    const float loop_s = (float)((SITL_STEP_US + 2.0 * SITL_SPIN_US) * 1e-6);
+    Bounds b = {0.0f, 0.0f, 0.0f, 0.0f, HOLD_BAND_PULSES};
+
+    if (sc.hold && sc.load_pct > 0.0f) {
+        float pull = 0.0f, pull_s = 0.0f, drop = 0.0f;
+        for (const Fault& f : sc.faults) {
+            if (f.kind == F_LOAD) { pull = f.mag; pull_s = f.dur_s; }
+            if (f.kind == F_DROP) drop = f.mag;
+        }
+        const float K = g_plant.gain_pps_per_pct;
+        const float dz = g_plant.deadzone_pct;
+        float peak = (pull + dz) / ps.hold_kp + K * pull * (SPEED_LOOP_DT_S + g_plant.tau_s);
+        peak /= 1.0f - drop;
+        b.band_pulses = HOLD_BAND_PULSES + 2.0f * peak * drop / (1.0f - drop);
+
+        float a = K * ps.hold_kp, c = K * ps.hold_ki, disc = a * a - 4.0f * c;
+        float slow = (disc > 0.0f) ? 0.5f * (a - sqrtf(disc)) : 0.5f * a;
+        float stick_s = 2.0f * dz / (ps.hold_ki * (b.band_pulses + 1.0f));
+        b.settle_s = pull_s + stick_s + 4.0f / slow +
+                     hold_settle_s(g_plant, shaper_duration_s(g_shaper.s)) + loop_s;
+        b.peak_m = peak / ppm;
+        b.line_err_m = b.band_pulses / ppm;
+        return b;
+    }
+
+    if (sc.hold) {
+        float rate = 0.0f, slip_s = 0.0f, drop = 0.0f, delay_s = 0.0f;
+        for (const Fault& f : sc.faults) {
+            if (f.kind == F_SLIP) { rate = f.mag; slip_s = f.dur_s; }
+            if (f.kind == F_DROP) drop = f.mag;
+            if (f.kind == F_PWM_DELAY) delay_s = f.mag;
+        }
+        uint32_t edges = edges_for_counted(ps.deadband_pulses + 1, drop);
+        b.latency_s = (float)edges / rate + loop_s;
+        float unseen = rate * fmaxf(slip_s - (float)(ps.deadband_pulses + 1) / rate, 0.0f);
+        float nudge_coast = tune_brake_distance_pulses(g_plant, g_plant.deadzone_pct + 5.0f, ps.brake_rate);
+        float err = (float)ps.deadband_pulses + 1.0f + nudge_coast + unseen;
+        err += rate * slip_s * drop / (1.0f - drop);
+        err += speed_for_duty(g_plant, ps.nudge_speed) * delay_s;
+        b.line_err_m = err / ppm;
+        return b;
+    }
+
+    float pad_pps = speed_for_duty(g_plant, ps.padding_speed);
+    b.line_err_m = (tune_brake_distance_pulses(g_plant, ps.padding_speed, ps.brake_rate) + 1.0f) / ppm;
+    for (const Fault& f : sc.faults) {
+        switch (f.kind) {
+            case F_DROP:      b.line_err_m += edges_lost_max(sc.meters * ppm, f.mag) / ppm; break;
+            case F_DUP:       b.line_err_m += sc.meters * f.mag / (1.0f + f.mag); break;
+            case F_NOISE:     b.line_err_m += f.mag * (sc.meters * ppm / pad_pps) / ppm; break;
+            case F_PWM_DELAY: b.line_err_m += pad_pps * f.mag / ppm; break;
+            case F_FREEZE:    b.latency_s = 2.0f * window_s + loop_s; break;
+            case F_SAG:
+                if (sc.expect == OUT_STALL) b.latency_s = 2.0f * window_s + 3.0f * g_plant.tau_s + loop_s;
+                break;
+            default: break;
+        }
+    }
+    if (sc.expect != OUT_OK) b.line_err_m = 0.0f;
+    return b;
+}
+
+static bool run_scenario(const Scenario& sc, uint32_t runs, unsigned jobs) {
+    Bounds bound = scenario_bounds(sc);
+    std::vector<float> onsets(runs);
+    for (uint32_t i = 0; i < runs; i++) {
+        onsets[i] = sc.onset_min_s + (sc.onset_max_s - sc.onset_min_s) * (float)i / (float)(runs > 1 ? runs - 1 : 1);
+    }
+
+    std::vector<RunResult> results(runs);
+    std::vector<bool> done = sitl_fork_runs(results, jobs, [&](size_t i, RunResult& r) {
+        run_one(sc, onsets[i], bound.band_pulses, 1000u + (uint32_t)i, r);
+    });
+
+    uint32_t pass = 0;
+    float worst_lat = 0.0f, sum_lat = 0.0f, worst_err = 0.0f, worst_peak = 0.0f, worst_settle = 0.0f;
+    uint32_t reacted = 0;
+    const char* why = "";
+
+    for (uint32_t i = 0; i < runs; i++) {
+        const RunResult& r = results[i];
+        if (!done[i]) { why = "firmware run died"; continue; }
+
+        bool ok = r.outcome == sc.expect;
+        if (!ok) why = OUTCOME_NAMES[r.outcome];
+
+        if (bound.latency_s > 0.0f) {
+            float lat = (r.react_t >= 0.0f) ? r.react_t - onsets[i] : 1e9f;
+            if (r.react_t >= 0.0f) {
+                reacted++;
+                sum_lat += lat;
+                if (lat > worst_lat) worst_lat = lat;
+            }
+            if (lat > bound.latency_s) { ok = false; why = "late"; }
+        }
+
+        float err = fabsf(r.line_err_m);
+        if (r.outcome == OUT_OK || r.outcome == OUT_NUDGE) {
+            if (err > worst_err) worst_err = err;
+            if (bound.line_err_m > 0.0f && err > bound.line_err_m) { ok = false; why = "line error"; }
+        }
+
+        if (bound.peak_m > 0.0f) {
+            float settle = fmaxf(r.out_t - onsets[i], 0.0f);
+            if (r.peak_m > worst_peak) worst_peak = r.peak_m;
+            if (settle > worst_settle) worst_settle = settle;
+            if (r.peak_m > bound.peak_m) { ok = false; why = "slip"; }
+            if (settle > bound.settle_s) { ok = false; why = "settling"; }
+        }
+
+        if (ok) pass++;
+    }
+
+    bool all = pass == runs;
+    printf("[FAULT] %-16s %-9s expect=%-7s pass=%u/%u latency=", sc.name,
+           FAULT_NAMES[sc.faults[0].kind], OUTCOME_NAMES[sc.expect], pass, runs);
+    if (reacted) printf("%.3f s (<=%.3f) mean=%.3f s", (double)worst_lat, (double)bound.latency_s, (double)(sum_lat / reacted));
+    else         printf("-");
+    printf(" line_err=%.1f mm", (double)(1000.0f * worst_err));
+    if (bound.line_err_m > 0.0f) printf(" (<=%.1f)", (double)(1000.0f * bound.line_err_m));
+    if (bound.peak_m > 0.0f) {
+        printf(" slip=%.1f mm (<=%.1f) settle=%.2f s (<=%.2f)", (double)(1000.0f * worst_peak),
+               (double)(1000.0f * bound.peak_m), (double)worst_settle, (double)bound.settle_s);
+    }
+    printf("%s%s\n", all ? "" : " FAIL: ", all ? "" : why);
+    return all;
+}
+
+int main(int argc, char** argv) {
+    unsigned jobs = (unsigned)sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t runs = 20;
+    const char* only = nullptr;
+    int pos = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) jobs = (unsigned)atoi(argv[++i]);
+        else if (pos == 0) { runs = (uint32_t)atoi(argv[i]); pos++; }
+        else if (pos == 1) { only = argv[i]; pos++; }
+        else {
+            fprintf(stderr, "usage: fault_sim [-j jobs] [runs] [scenario]\n");
+            return 2;
+        }
+    }
+    if (runs == 0) runs = 1;
+
+    sitl_mute(true);
+    sitl_boot(WINCH_VARIANT);
+    sitl_mute(false);
+    g_sitl.line_out = 0.5 * g_winch.v->max_line_m * g_winch.pulses_per_meter;   // room to wind in
+    printf("[FAULT] %s, %u runs per scenario, onset spread over each scenario's window\n", g_winch.v->name, runs);
+
+    bool ok = true;
+    uint32_t ran = 0;
+    for (uint32_t i = 0; i < SCENARIO_COUNT; i++) {
+        if (only && strcmp(only, SCENARIOS[i].name) != 0) continue;
+        ok = run_scenario(SCENARIOS[i], runs, jobs) && ok;
+        ran++;
+    }
+    if (ran == 0) {
+        fprintf(stderr, "no scenario named %s\n", only);
+        return 2;
+    }
+
+    printf("[FAULT] %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,412 @@
+// Per-operation performance KPIs from recorded trace files, across a fleet.
+//
+// Build: g++ -O2 -std=c++17 -pthread -I../Motor-Control fleet_kpi.cpp -o fleet_kpi
+// Usage: fleet_kpi [-j threads] [--variant n] [-o ops.csv] [--t-max C] [--ambient C]
+//                  [--rth K/W] [--tau-th s] <trace files...>
+//
+// Each trace (trace_file.h; from trace_tool import, or written by a host tool) is split into
+// operations at its events:
+//   move  MOVE_START .. MOVE_END / STALL / TIMEOUT, then the coast until the drum is still
+//   hold  HOLD_START .. HOLD_END
+// and every operation gets: duration, distance, average and peak line speed, stop error (coast
+// past the point where the stop was commanded), overshoot (how far the coast went past where
+// the drum came to rest), stall and nudge counts, line moved during a hold, and thermal
+// headroom. Headroom is max winding temperature minus the peak of a first-order winding model
+// (copper loss from duty, edge speed and the variant's electrical constants) run over the
+// whole trace.
+// Files are processed in parallel; the summary gives count and p50 / p90 / p99 of each KPI
+// per unit and per firmware version (from the trace header). -o also writes one CSV row per
+// operation.
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "winch_variants.h"
+#include "winch_model.h"
+#include "energy_profile.h"
+#include "trace_file.h"
+
+static constexpr uint64_t SETTLE_GAP_US = 300000;   // no edge for this long = drum at rest
+static constexpr uint32_t PEAK_EDGES    = 4;        // peak speed over this many edge intervals
+
+struct Thermal {
+    float t_max_c;
+    float ambient_c;
+    float rth_k_per_w;
+    float tau_s;
+};
+
+enum OpType : uint8_t { OP_MOVE, OP_HOLD };
+enum OpOutcome : uint8_t { OUT_OK, OUT_STALL, OUT_TIMEOUT };
+
+struct OpKpi {
+    OpType    type;
+    OpOutcome outcome;
+    double    t_start_s;       // from the start of the trace
+    float     duration_s;      // move: start to stop command; hold: whole hold
+    float     dist_m;
+    float     avg_mps;
+    float     peak_mps;
+    float     stop_err_m;
+    float     overshoot_m;
+    float     headroom_c;
+    uint32_t  stalls;
+    uint32_t  nudges;
+    uint32_t  slip_pulses;     // hold: edges during the hold
+};
+
+struct FileKpi {
+    bool               ok = false;
+    uint32_t           unit = 0;
+    std::string        fw;
+    std::vector<OpKpi> ops;
+    uint32_t           incomplete = 0;
+};
+
+struct Context {
+    float     ppm;
+    MotorElec elec;
+    float     rad_per_pulse;
+    Thermal   th;
+};
+
+// ---- Segmentation ----
+
+struct Segmenter {
+    const Context* cx;
+    FileKpi*       out;
+    uint64_t       t0_us;
+
+    // winding model, fed by samples
+    float    temp_c;
+    uint64_t t_sample;
+    uint32_t edges_since_sample;
+    float    duty_pct;
+
+    // operation in progress
+    bool     open;
+    bool     settling;
+    OpKpi    op;
+    uint64_t t_op, t_end;
+    int32_t  pos_start, pos_end;
+    float    peak_temp;
+
+    // edges
+    int32_t  pos;
+    uint64_t t_last_edge;
+    uint64_t edge_t[PEAK_EDGES + 1];
+    uint32_t edge_n;
+    int32_t  excursion;        // furthest from pos_end while settling
+};
+
+static void seg_init(Segmenter& s, const Context& cx, FileKpi& out, uint64_t t0_us) {
+    memset(&s, 0, sizeof(s));
+    s.cx = &cx;
+    s.out = &out;
+    s.t0_us = t0_us;
+    s.temp_c = cx.th.ambient_c;
+    s.t_sample = t0_us;
+}
+
+static void seg_open(Segmenter& s, OpType type, uint64_t t, int32_t pos) {
+    memset(&s.op, 0, sizeof(s.op));
+    s.op.type = type;
+    s.op.t_start_s = (double)(t - s.t0_us) * 1e-6;
+    s.open = true;
+    s.settling = false;
+    s.t_op = t;
+    s.pos_start = pos;
+    s.edge_n = 0;
+    s.peak_temp = s.temp_c;
+}
+
+static void seg_close(Segmenter& s) {
+    const float ppm = s.cx->ppm;
+    OpKpi& op = s.op;
+
+    if (op.type == OP_MOVE) {
+        float rest = (float)abs(s.pos - s.pos_end);
+        op.dist_m = (float)abs(s.pos_end - s.pos_start) / ppm;
+        op.avg_mps = (op.duration_s > 0.0f) ? op.dist_m / op.duration_s : 0.0f;
+        op.stop_err_m = rest / ppm;
+        op.overshoot_m = ((float)s.excursion - rest) / ppm;
+    } else {
+        op.dist_m = (float)abs(s.pos - s.pos_start) / ppm;
+    }
+    op.headroom_c = s.cx->th.t_max_c - s.peak_temp;
+
+    s.out->ops.push_back(op);
+    s.open = false;
+    s.settling = false;
+}
+
+static void seg_end_move(Segmenter& s, uint64_t t, OpOutcome outcome) {
+    s.op.outcome = outcome;
+    if (outcome == OUT_STALL) s.op.stalls++;
+    s.op.duration_s = (float)(t - s.t_op) * 1e-6f;
+    s.t_end = t;
+    s.pos_end = s.pos;
+    s.excursion = 0;
+    s.settling = true;
+}
+
+static void seg_thermal(Segmenter& s, uint64_t t, float duty_pct) {
+    const MotorElec& e = s.cx->elec;
+    float dt = (float)(t - s.t_sample) * 1e-6f;
+    if (dt > 0.0f) {
+        // armature current from applied voltage against back-EMF at the measured speed
+        float omega = (float)s.edges_since_sample / dt * s.cx->rad_per_pulse;
+        float amps = (e.supply_v * fabsf(s.duty_pct) * 0.01f - e.ke * omega) / e.r_ohm;
+        float loss_w = amps * amps * e.r_ohm;
+
+        float target = s.cx->th.ambient_c + loss_w * s.cx->th.rth_k_per_w;
+        float a = dt / s.cx->th.tau_s;
+        s.temp_c += (target - s.temp_c) * (a > 1.0f ? 1.0f : a);
+        if (s.open && s.temp_c > s.peak_temp) s.peak_temp = s.temp_c;
+    }
+    s.t_sample = t;
+    s.edges_since_sample = 0;
+    s.duty_pct = duty_pct;
+}
+
+static void seg_record(Segmenter& s, uint64_t t, const TraceRecord& r) {
+    // a move's coast ends when the drum has been still for a while, or at the next event
+    if (s.settling) {
+        bool still = t - s.t_last_edge > SETTLE_GAP_US && t - s.t_end > SETTLE_GAP_US;
+        if (still || r.kind == TRACE_EVENT) seg_close(s);
+    }
+
+    switch (r.kind) {
+    case TRACE_EDGE:
+        s.pos = r.pos;
+        s.t_last_edge = t;
+        s.edges_since_sample++;
+        if (!s.open) break;
+
+        if (s.settling) {
+            int32_t d = abs(s.pos - s.pos_end);
+            if (d > s.excursion) s.excursion = d;
+        } else if (s.op.type == OP_MOVE) {
+            s.edge_t[s.edge_n % (PEAK_EDGES + 1)] = t;
+            s.edge_n++;
+            if (s.edge_n > PEAK_EDGES) {
+                uint64_t span = t - s.edge_t[s.edge_n % (PEAK_EDGES + 1)];
+                float mps = (span > 0) ? (float)PEAK_EDGES * 1e6f / (float)span / s.cx->ppm : 0.0f;
+                if (mps > s.op.peak_mps) s.op.peak_mps = mps;
+            }
+        } else {
+            s.op.slip_pulses++;
+        }
+        break;
+
+    case TRACE_SAMPLE:
+        s.pos = r.pos;
+        seg_thermal(s, t, (float)r.duty_c * 0.01f);
+        break;
+
+    case TRACE_EVENT:
+        s.pos = r.pos;
+        switch (r.arg) {
+        case TRACE_EV_MOVE_START:
+        case TRACE_EV_HOLD_START:
+            if (s.open) s.out->incomplete++;
+            seg_open(s, r.arg == TRACE_EV_MOVE_START ? OP_MOVE : OP_HOLD, t, r.pos);
+            break;
+        case TRACE_EV_MOVE_END:
+        case TRACE_EV_STALL:
+        case TRACE_EV_TIMEOUT:
+            if (s.open && s.op.type == OP_MOVE) {
+                seg_end_move(s, t, r.arg == TRACE_EV_MOVE_END ? OUT_OK
+                                 : (r.arg == TRACE_EV_STALL ? OUT_STALL : OUT_TIMEOUT));
+            } else if (s.open && r.arg == TRACE_EV_STALL) {
+                s.op.stalls++;   // a nudge that didn't turn the drum
+            }
+            break;
+        case TRACE_EV_HOLD_END:
+            if (s.open && s.op.type == OP_HOLD) {
+                s.op.duration_s = (float)(t - s.t_op) * 1e-6f;
+                seg_close(s);
+            }
+            break;
+        case TRACE_EV_NUDGE:
+            if (s.open) s.op.nudges++;
+            break;
+        }
+        break;
+    }
+}
+
+static void process_file(const char* path, const Context& cx, FileKpi& out) {
+    TraceMap m;
+    if (!trace_map_open(m, path)) return;
+
+    out.unit = m.view.hdr->unit_id;
+    out.fw.assign(m.view.hdr->fw_version, strnlen(m.view.hdr->fw_version, sizeof(m.view.hdr->fw_version)));
+
+    Segmenter s;
+    seg_init(s, cx, out, m.view.hdr->t_start_us);
+
+    TraceCursor c;
+    trace_rewind(c, m.view);
+    const TraceRecord* r;
+    uint64_t t;
+    while (trace_next(c, &r, &t)) seg_record(s, t, *r);
+
+    if (s.settling) seg_close(s);
+    else if (s.open) out.incomplete++;
+
+    trace_map_close(m);
+    out.ok = true;
+}
+
+// ---- Summary ----
+
+struct Group {
+    uint32_t moves = 0, holds = 0, stalls = 0, timeouts = 0, nudges = 0;
+    std::vector<float> move_s, avg_mps, peak_mps, stop_err_mm, overshoot_mm, headroom_c;
+    std::vector<float> hold_nudges, hold_slip_mm;
+};
+
+static void group_add(Group& g, const OpKpi& op, float ppm) {
+    g.stalls += op.stalls;
+    g.nudges += op.nudges;
+    g.headroom_c.push_back(op.headroom_c);
+
+    if (op.type == OP_HOLD) {
+        g.holds++;
+        g.hold_nudges.push_back((float)op.nudges);
+        g.hold_slip_mm.push_back(1000.0f * (float)op.slip_pulses / ppm);
+        return;
+    }
+
+    g.moves++;
+    if (op.outcome == OUT_TIMEOUT) g.timeouts++;
+    if (op.outcome != OUT_OK) return;   // a failed move's timing says nothing about throughput
+
+    g.move_s.push_back(op.duration_s);
+    g.avg_mps.push_back(op.avg_mps);
+    g.peak_mps.push_back(op.peak_mps);
+    g.stop_err_mm.push_back(1000.0f * op.stop_err_m);
+    g.overshoot_mm.push_back(1000.0f * op.overshoot_m);
+}
+
+// Nearest-rank percentile; v is sorted in place
+static float percentile(std::vector<float>& v, float p) {
+    if (v.empty()) return 0.0f;
+    size_t k = (size_t)ceilf(p / 100.0f * (float)v.size());
+    return v[k > 0 ? k - 1 : 0];
+}
+
+static void print_kpi(const char* name, std::vector<float>& v) {
+    if (v.empty()) return;
+    std::sort(v.begin(), v.end());
+    printf("  %-14s n=%-6zu p50=%-9.3f p90=%-9.3f p99=%-9.3f\n", name, v.size(),
+           (double)percentile(v, 50.0f), (double)percentile(v, 90.0f), (double)percentile(v, 99.0f));
+}
+
+static void print_group(const std::string& key, Group& g) {
+    printf("[KPI] %s moves=%u stalls=%u timeouts=%u holds=%u nudges=%u\n", key.c_str(),
+           g.moves, g.stalls, g.timeouts, g.holds, g.nudges);
+    print_kpi("move_s", g.move_s);
+    print_kpi("avg_mps", g.avg_mps);
+    print_kpi("peak_mps", g.peak_mps);
+    print_kpi("stop_err_mm", g.stop_err_mm);
+    print_kpi("overshoot_mm", g.overshoot_mm);
+    print_kpi("hold_nudges", g.hold_nudges);
+    print_kpi("hold_slip_mm", g.hold_slip_mm);
+    print_kpi("headroom_c", g.headroom_c);
+}
+
+int main(int argc, char** argv) {
+    unsigned threads = std::thread::hardware_concurrency();
+    uint32_t variant = WINCH_VARIANT;
+    const char* csv_path = nullptr;
+    Thermal th = {120.0f, 25.0f, 6.0f, 900.0f};
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) threads = (unsigned)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--variant") == 0 && i + 1 < argc) variant = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) csv_path = argv[++i];
+        else if (strcmp(argv[i], "--t-max") == 0 && i + 1 < argc) th.t_max_c = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--ambient") == 0 && i + 1 < argc) th.ambient_c = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--rth") == 0 && i + 1 < argc) th.rth_k_per_w = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--tau-th") == 0 && i + 1 < argc) th.tau_s = strtof(argv[++i], nullptr);
+        else files.push_back(argv[i]);
+    }
+    if (files.empty() || !(th.tau_s > 0.0f)) {
+        fprintf(stderr, "usage: fleet_kpi [-j threads] [--variant n] [-o ops.csv] [--t-max C] [--ambient C]\n"
+                        "                 [--rth K/W] [--tau-th s] <trace files...>\n");
+        return 2;
+    }
+    if (threads == 0) threads = 1;
+
+    WinchDerived w = winch_derive(variant);
+    PlantParams p = plant_default_params(w.full_speed_pps, w.pulses_per_meter);
+    Context cx;
+    cx.ppm = w.pulses_per_meter;
+    cx.elec = motor_elec_from(w, p);
+    cx.rad_per_pulse = 2.0f * (float)M_PI / (float)w.v->fg_pulses_per_motor_rev;
+    cx.th = th;
+
+    std::vector<FileKpi> results(files.size());
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back([&] {
+            for (size_t i; (i = next.fetch_add(1)) < files.size();) process_file(files[i], cx, results[i]);
+        });
+    }
+    for (std::thread& t : pool) t.join();
+
+    FILE* csv = nullptr;
+    if (csv_path) {
+        csv = fopen(csv_path, "w");
+        if (!csv) { fprintf(stderr, "cannot write %s\n", csv_path); return 1; }
+        fprintf(csv, "file,unit,fw,type,outcome,t_start_s,duration_s,dist_m,avg_mps,peak_mps,"
+                     "stop_err_m,overshoot_m,stalls,nudges,slip_pulses,headroom_c\n");
+    }
+
+    static const char* TYPE[] = {"move", "hold"};
+    static const char* OUTCOME[] = {"ok", "stall", "timeout"};
+
+    std::map<std::string, Group> by_unit, by_fw;
+    uint32_t failed = 0, incomplete = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        const FileKpi& f = results[i];
+        if (!f.ok) { failed++; fprintf(stderr, "cannot read %s\n", files[i]); continue; }
+        incomplete += f.incomplete;
+
+        char unit_key[64];
+        snprintf(unit_key, sizeof(unit_key), "unit=%u fw=%s", (unsigned)f.unit, f.fw.c_str());
+        Group& gu = by_unit[unit_key];
+        Group& gf = by_fw["fw=" + f.fw];
+
+        for (const OpKpi& op : f.ops) {
+            group_add(gu, op, cx.ppm);
+            group_add(gf, op, cx.ppm);
+            if (csv) {
+                fprintf(csv, "%s,%u,%s,%s,%s,%.3f,%.3f,%.4f,%.4f,%.4f,%.4f,%.4f,%u,%u,%u,%.1f\n",
+                        files[i], (unsigned)f.unit, f.fw.c_str(), TYPE[op.type], OUTCOME[op.outcome],
+                        op.t_start_s, (double)op.duration_s, (double)op.dist_m, (double)op.avg_mps,
+                        (double)op.peak_mps, (double)op.stop_err_m, (double)op.overshoot_m,
+                        (unsigned)op.stalls, (unsigned)op.nudges, (unsigned)op.slip_pulses,
+                        (double)op.headroom_c);
+            }
+        }
+    }
+    if (csv) fclose(csv);
+
+    for (auto& kv : by_unit) print_group(kv.first, kv.second);
+    for (auto& kv : by_fw) print_group(kv.first, kv.second);
+    printf("[KPI] files=%zu failed=%u incomplete_ops=%u\n", files.size(), failed, incomplete);
+    return failed ? 1 : 0;
+}
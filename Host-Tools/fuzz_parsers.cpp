@@ -0,0 +1,564 @@
+// Fuzz targets for the parsers that take input from outside the device: command lines
+// (line_feed, split_args, arg_float / arg_u32), parameter commands and saved records
+// (params_command, params_from_record), the on-device trace stream (trace_dec_next), the trace
+// container reader (trace_view_open and the cursor walk) and rangefinder frames
+// (range_parse_byte). Besides memory errors and undefined behaviour, each target checks the
+// parser's own promises: tokens inside the line, accepted numbers within range, parameters
+// within bounds after any input, decoded time never going backwards, records inside the file.
+// The first input byte picks the target (mod 5), so one corpus covers all five.
+//
+// libFuzzer (clang), coverage guided:
+//   clang++ -g -O1 -std=c++17 -fsanitize=fuzzer,address,undefined -I../Motor-Control fuzz_parsers.cpp -o fuzz_parsers
+//   ./fuzz_parsers -close_fd_mask=1 fuzz_corpus/
+// Without clang, a plain mutational driver (no coverage feedback) under the same sanitizers:
+//   g++ -g -O1 -std=c++17 -fsanitize=address,undefined -fno-sanitize-recover=all -DFUZZ_STANDALONE -I../Motor-Control fuzz_parsers.cpp -o fuzz_parsers
+//   ./fuzz_parsers [--runs n] [--seed s] fuzz_corpus/    replay the corpus, then mutate it
+//   ./fuzz_parsers crash-file...                         replay single inputs
+//   ./fuzz_parsers --make-corpus fuzz_corpus             regenerate the seed corpus
+// A failing input is written to fuzz_crash.bin (standalone) before the process aborts.
+//
+// Seeds: the command lines of a sitl session (mission cycle, parameter edits, nudges, trace and
+// maintenance readback), a saved parameter record, an encoded move, a small trace file and a
+// stream of TFmini frames.
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "command_link.h"
+#include "params.h"
+#include "trace_file.h"
+#include "trace_codec.h"
+#include "rangefinder.h"
+
+enum FuzzTarget : uint8_t {
+    FUZZ_COMMAND = 0,
+    FUZZ_PARAMS  = 1,
+    FUZZ_TRACE_STREAM = 2,
+    FUZZ_TRACE_FILE   = 3,
+    FUZZ_RANGE   = 4,
+    FUZZ_TARGET_COUNT
+};
+
+static const char* const TARGET_NAMES[FUZZ_TARGET_COUNT] = {"command", "params", "stream", "tracefile", "range"};
+
+// Input under test, kept so a failure can be written out
+static const uint8_t* g_input;
+static size_t g_input_len;
+
+#define FUZZ_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "[FUZZ] %s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            abort(); \
+        } \
+    } while (0)
+
+// ---- command lines ----
+
+static void check_args(char** argv, int argc, const char* line, size_t len) {
+    FUZZ_CHECK(argc >= 0 && argc <= CMD_ARGS_MAX);
+    for (int a = 0; a < argc; a++) {
+        FUZZ_CHECK(argv[a] >= line && argv[a] < line + len);
+        FUZZ_CHECK(*argv[a] != '\0' && strchr(argv[a], ' ') == nullptr);
+    }
+}
+
+// The argument ranges the firmware's commands use
+static void fuzz_command(const uint8_t* d, size_t n) {
+    LineBuffer lb;
+    memset(&lb, 0, sizeof(lb));
+
+    for (size_t i = 0; i < n; i++) {
+        if (!line_feed(lb, d[i])) continue;
+
+        size_t len = strlen(lb.buf);
+        FUZZ_CHECK(len > 0 && len < (size_t)CMD_LINE_MAX);
+
+        char* argv[CMD_ARGS_MAX];
+        int argc = split_args(lb.buf, argv, CMD_ARGS_MAX);
+        check_args(argv, argc, lb.buf, len);
+
+        for (int a = 0; a < argc; a++) {
+            float f;
+            uint32_t u;
+            if (arg_float(argv[a], 0.001f, 25.0f, &f))   FUZZ_CHECK(f >= 0.001f && f <= 25.0f);
+            if (arg_float(argv[a], 0.0f, 3600.0f, &f))   FUZZ_CHECK(f >= 0.0f && f <= 3600.0f);
+            if (arg_float(argv[a], -1e30f, 1e30f, &f))   FUZZ_CHECK(isfinite(f));
+            if (arg_u32(argv[a], 1, 3600000, &u))        FUZZ_CHECK(u >= 1 && u <= 3600000);
+            if (arg_u32(argv[a], 0, 0xFFFFFFFFu, &u))    FUZZ_CHECK(argv[a][0] >= '0' && argv[a][0] <= '9');
+        }
+    }
+}
+
+// ---- parameter commands and records ----
+
+static void check_params(const ParamSet& s) {
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        float v = param_get(s, PARAM_DEFS[i]);
+        FUZZ_CHECK(v >= PARAM_DEFS[i].min_v && v <= PARAM_DEFS[i].max_v);
+    }
+}
+
+// A saved record (as much as the input holds), then the rest as "param ..." command lines
+static void fuzz_params(const uint8_t* d, size_t n) {
+    static ParamBank b;
+    param_bank_init(b);
+
+    ParamRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    size_t k = (n < sizeof(rec)) ? n : sizeof(rec);
+    memcpy(&rec, d, k);
+    size_t applied = params_from_record(b.staging, rec);
+    FUZZ_CHECK(applied <= PARAM_RECORD_MAX);
+    check_params(b.staging);
+
+    LineBuffer lb;
+    memset(&lb, 0, sizeof(lb));
+    for (size_t i = k; i < n; i++) {
+        if (!line_feed(lb, d[i])) continue;
+
+        char line[CMD_LINE_MAX + 8];
+        strcpy(line, "param ");
+        strncat(line, lb.buf, sizeof(line) - strlen(line) - 1);
+
+        char* argv[CMD_ARGS_MAX];
+        int argc = split_args(line, argv, CMD_ARGS_MAX);
+        params_command(b, argc, argv);
+        param_bank_tick(b);
+
+        check_params(b.staging);
+        check_params(b.sets[0]);
+        check_params(b.sets[1]);
+    }
+
+    // whatever was accepted round-trips through the saved format unchanged
+    ParamRecord out;
+    ParamSet back;
+    params_to_record(b.staging, out);
+    params_defaults(back);
+    FUZZ_CHECK(params_from_record(back, out) == PARAM_COUNT);
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        FUZZ_CHECK(param_get(back, PARAM_DEFS[i]) == param_get(b.staging, PARAM_DEFS[i]));
+    }
+}
+
+// ---- trace stream (trace_codec.h) ----
+
+static void fuzz_trace_stream(const uint8_t* d, size_t n) {
+    TraceDecoder dec;
+    trace_dec_init(dec, d, n);
+
+    TraceRecord r;
+    uint64_t t, t_prev = 0;
+    bool first = true;
+    const uint8_t* p_prev = dec.p;
+
+    while (trace_dec_next(dec, &r, &t)) {
+        FUZZ_CHECK(dec.p > p_prev && dec.p <= dec.end);
+        FUZZ_CHECK(r.kind <= TRACE_EVENT);
+        if (r.kind == TRACE_EVENT) FUZZ_CHECK(r.arg >= TRACE_EV_MOVE_START && r.arg <= TRACE_EV_NUDGE);
+        FUZZ_CHECK(r.duty_c >= -32767 && r.duty_c <= 32767);
+        if (!first) {
+            FUZZ_CHECK(t >= t_prev);
+            FUZZ_CHECK(r.dt_us == (uint32_t)(t - t_prev));
+        }
+        first = false;
+        t_prev = t;
+        p_prev = dec.p;
+    }
+    FUZZ_CHECK(dec.p <= dec.end);
+}
+
+// ---- trace container (trace_file.h) ----
+
+static void fuzz_trace_file(const uint8_t* d, size_t n) {
+    // exactly sized and malloc-aligned, as a mapping would be, so any read past it is caught
+    uint8_t* mem = (uint8_t*)malloc(n ? n : 1);
+    memcpy(mem, d, n);
+
+    TraceView v;
+    if (trace_view_open(v, mem, n)) {
+        const uint8_t* lo = mem + sizeof(TraceHeader);
+        const uint8_t* hi = mem + v.hdr->index_offset;
+
+        uint64_t total = 0;
+        for (uint32_t c = 0; c < v.hdr->chunk_count; c++) total += v.index[c].count;
+
+        TraceCursor cur;
+        const TraceRecord* r;
+        uint64_t t;
+        uint64_t seen = 0;
+        trace_rewind(cur, v);
+        while (trace_next(cur, &r, &t)) {
+            FUZZ_CHECK((const uint8_t*)r >= lo && (const uint8_t*)(r + 1) <= hi);
+            seen++;
+        }
+        FUZZ_CHECK(seen == total);
+
+        if (v.hdr->chunk_count > 0) {
+            uint64_t at[3] = {0, v.index[v.hdr->chunk_count / 2].t_first_us,
+                              v.index[v.hdr->chunk_count - 1].t_last_us};
+            for (uint64_t ts : at) {
+                trace_seek(cur, v, ts);
+                for (int k = 0; k < 4 && trace_next(cur, &r, &t); k++) {
+                    FUZZ_CHECK((const uint8_t*)r >= lo && (const uint8_t*)(r + 1) <= hi);
+                }
+            }
+        }
+    }
+    free(mem);
+}
+
+// ---- rangefinder frames (rangefinder.h) ----
+
+static void fuzz_range(const uint8_t* d, size_t n) {
+    RangeParser p;
+    memset(&p, 0, sizeof(p));
+    if (n == 0) return;
+    p.n = d[0] % 16;   // any state, including one out of range
+
+    for (size_t i = 1; i < n; i++) {
+        float m;
+        if (range_parse_byte(p, d[i], &m)) {
+            FUZZ_CHECK(m >= 0.01f && m <= 655.35f);
+
+            // a reading survives a re-encode
+            uint8_t frame[RANGE_FRAME_LEN];
+            RangeParser q;
+            float m2 = -1.0f;
+            bool ok = false;
+            memset(&q, 0, sizeof(q));
+            range_encode_frame(frame, m, 1000);
+            for (uint32_t k = 0; k < RANGE_FRAME_LEN; k++) ok = range_parse_byte(q, frame[k], &m2);
+            FUZZ_CHECK(ok && fabsf(m2 - m) < 0.005f);
+        }
+        FUZZ_CHECK(p.n < RANGE_FRAME_LEN);
+    }
+}
+
+extern "C" int LLVMFuzzerInitialize(int*, char***) {
+    // params_command prints every accepted line
+    if (!freopen("/dev/null", "w", stdout)) return 0;
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size == 0) return 0;
+    g_input = data;
+    g_input_len = size;
+
+    const uint8_t* d = data + 1;
+    size_t n = size - 1;
+    switch (data[0] % FUZZ_TARGET_COUNT) {
+    case FUZZ_COMMAND:      fuzz_command(d, n); break;
+    case FUZZ_PARAMS:       fuzz_params(d, n); break;
+    case FUZZ_TRACE_STREAM: fuzz_trace_stream(d, n); break;
+    case FUZZ_TRACE_FILE:   fuzz_trace_file(d, n); break;
+    case FUZZ_RANGE:        fuzz_range(d, n); break;
+    }
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+
+typedef std::vector<uint8_t> Bytes;
+
+static uint32_t xrand(uint32_t& s) {
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    return s;
+}
+
+static bool read_file(const std::string& path, Bytes& out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    out.clear();
+    uint8_t buf[4096];
+    size_t k;
+    while ((k = fread(buf, 1, sizeof(buf), f)) > 0) out.insert(out.end(), buf, buf + k);
+    fclose(f);
+    return true;
+}
+
+static bool write_file(const std::string& path, const Bytes& b) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(b.data(), 1, b.size(), f) == b.size();
+    return (fclose(f) == 0) && ok;
+}
+
+static void run_one(const Bytes& b) {
+    LLVMFuzzerTestOneInput(b.data(), b.size());
+}
+
+// Every sanitizer report ends in abort(), where on_crash saves the input
+extern "C" const char* __asan_default_options() { return "abort_on_error=1"; }
+extern "C" const char* __ubsan_default_options() { return "abort_on_error=1:print_stacktrace=1"; }
+
+static void on_crash(int sig) {
+    static const char msg[] = "[FUZZ] input written to fuzz_crash.bin\n";
+    int fd = open("fuzz_crash.bin", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        if (write(fd, g_input, g_input_len) == (ssize_t)g_input_len && write(2, msg, sizeof(msg) - 1)) {}
+        close(fd);
+    }
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+// ---- seed corpus ----
+
+static Bytes seed(FuzzTarget t, const void* p, size_t n) {
+    Bytes b(n + 1);
+    b[0] = (uint8_t)t;
+    memcpy(b.data() + 1, p, n);
+    return b;
+}
+
+static Bytes seed_text(FuzzTarget t, const char* s) {
+    return seed(t, s, strlen(s));
+}
+
+static void make_seeds(std::vector<std::pair<std::string, Bytes>>& out) {
+    // command lines typed at the sitl console
+    out.push_back({"command-cycle", seed_text(FUZZ_COMMAND,
+        "param set cycle_m 0.8\nparam set cycle_pause_ms 3000\nparam commit\nparam save\n"
+        "move out 1.5\nmove in 1.5 eco 20\nlower 1.0 60\n")});
+    out.push_back({"command-hold", seed_text(FUZZ_COMMAND,
+        "hold cal 2.5\nswing 4000\nshaper ident\nrange\nmaint\nmaint reset wear\ntrace dump\n")});
+    out.push_back({"command-edge", seed_text(FUZZ_COMMAND,
+        "move out 1e30\r\nmove   in  -0\nparam set padding_m nan\nmove out 0x10 eco 99999\n"
+        "a b c d e f g h i j k l\n")});
+
+    // saved parameter record, then edits
+    {
+        ParamSet s;
+        ParamRecord r;
+        params_defaults(s);
+        param_set(s, *param_find("cycle_m"), 1.2f);
+        param_set(s, *param_find("hold_mode"), 1.0f);
+        params_to_record(s, r);
+        Bytes b = seed(FUZZ_PARAMS, &r, sizeof(r));
+        const char* cmds = "set nudge_speed 35\nset 90 600\nget cycle_m\ncommit\nreset\nlist\nset slew_rate -1\n";
+        b.insert(b.end(), cmds, cmds + strlen(cmds));
+        out.push_back({"params-record", b});
+    }
+
+    // a move as the device encodes it: start, edges at cruise, samples, a nudge, the end
+    {
+        static uint8_t buf[2048];
+        TraceEncoder e;
+        trace_enc_init(e, buf, sizeof(buf));
+        trace_enc_start(e, 1000, 0, 0);
+        trace_enc_event(e, 1000, TRACE_EV_MOVE_START, 0);
+        uint32_t t = 1000;
+        int32_t pos = 0;
+        for (int k = 0; k < 120; k++) {
+            t += 2100 + (uint32_t)(k % 7) * 13;
+            trace_enc_edge(e, t, true);
+            pos++;
+            if (k % 10 == 0) trace_enc_sample(e, t + 50, pos, trace_duty_c(40.0f + 0.3f * k));
+        }
+        trace_enc_event(e, t + 300000, TRACE_EV_MOVE_END, pos);
+        trace_enc_event(e, t + 2300000, TRACE_EV_NUDGE, pos - 3);
+        trace_enc_edge(e, t + 2400000, false);
+        out.push_back({"stream-move", seed(FUZZ_TRACE_STREAM, buf, e.len)});
+    }
+
+    // a two-chunk trace file (chunk_max cut down so it stays small)
+    {
+        char path[] = "/tmp/fuzz_traceXXXXXX";
+        int fd = mkstemp(path);
+        if (fd >= 0) {
+            close(fd);
+            static TraceWriter w;
+            trace_writer_open(w, path, 7, "seed", 5000000);
+            w.hdr.chunk_max = 8;
+            for (int k = 0; k < 12; k++) {
+                trace_write(w, 5000000 + (uint64_t)k * 2000, (k % 4) ? TRACE_EDGE : TRACE_SAMPLE, 1, k, 40.0f);
+            }
+            trace_write(w, 5030000, TRACE_EVENT, TRACE_EV_MOVE_END, 11, 0.0f);
+            trace_writer_close(w);
+
+            Bytes f;
+            if (read_file(path, f)) out.push_back({"tracefile-two-chunks", seed(FUZZ_TRACE_FILE, f.data(), f.size())});
+            unlink(path);
+        }
+    }
+
+    // TFmini frames: good, weak, saturated, a bad checksum with a header inside
+    {
+        Bytes b(1, (uint8_t)FUZZ_RANGE);
+        b.push_back(0);
+        uint8_t fr[RANGE_FRAME_LEN];
+        const float d[] = {1.25f, 0.5f, 12.0f, 0.03f};
+        for (float m : d) {
+            range_encode_frame(fr, m, 800);
+            b.insert(b.end(), fr, fr + RANGE_FRAME_LEN);
+        }
+        range_encode_frame(fr, 2.0f, 40);
+        b.insert(b.end(), fr, fr + RANGE_FRAME_LEN);
+        range_encode_frame(fr, 2.0f, RANGE_BAD_STRENGTH);
+        b.insert(b.end(), fr, fr + RANGE_FRAME_LEN);
+        range_encode_frame(fr, 3.0f, 800);
+        fr[8] ^= 0x55;
+        fr[5] = fr[6] = RANGE_FRAME_HEAD;
+        b.insert(b.end(), fr, fr + RANGE_FRAME_LEN);
+        range_encode_frame(fr, 3.0f, 800);
+        b.insert(b.end(), fr, fr + RANGE_FRAME_LEN);
+        out.push_back({"range-frames", b});
+    }
+}
+
+static int make_corpus(const char* dir) {
+    mkdir(dir, 0755);
+    std::vector<std::pair<std::string, Bytes>> seeds;
+    make_seeds(seeds);
+    for (auto& s : seeds) {
+        std::string path = std::string(dir) + "/" + s.first;
+        if (!write_file(path, s.second)) {
+            fprintf(stderr, "cannot write %s\n", path.c_str());
+            return 1;
+        }
+        fprintf(stderr, "[FUZZ] %s (%zu bytes)\n", path.c_str(), s.second.size());
+    }
+    return 0;
+}
+
+// ---- mutation ----
+
+static const uint8_t INTERESTING[] = {0x00, 0x01, 0x7F, 0x80, 0xFF, ' ', '\n', '-', '.', 'e', '0', '9',
+                                      RANGE_FRAME_HEAD, (uint8_t)TRACE_EV_NUDGE};
+
+// Boundary values for multi-byte fields (lengths, offsets, counts), written little-endian
+static const uint64_t INTERESTING_WORDS[] = {0, 1, 0x7F, 0x80, 0xFF, 0x7FFF, 0xFFFF, 0x7FFFFFFF,
+                                             0xFFFFFFFF, 0x100000000ull, 0x7FFFFFFFFFFFFFFFull,
+                                             0xFFFFFFFFFFFFFFF0ull, 0xFFFFFFFFFFFFFFFFull};
+
+// A few random edits past the target byte, sometimes splicing in a piece of another input
+static void mutate(Bytes& b, uint32_t& r, const std::vector<Bytes>& corpus) {
+    int edits = 1 + (int)(xrand(r) % 6);
+    for (int k = 0; k < edits; k++) {
+        size_t n = b.size();
+        size_t at = 1 + ((n > 1) ? xrand(r) % (n - 1) : 0);
+
+        switch (xrand(r) % 8) {
+        case 0: if (at < n) b[at] ^= (uint8_t)(1u << (xrand(r) % 8)); break;
+        case 1: if (at < n) b[at] = (uint8_t)xrand(r); break;
+        case 2: if (at < n) b[at] = INTERESTING[xrand(r) % sizeof(INTERESTING)]; break;
+        case 3: b.insert(b.begin() + at, (uint8_t)xrand(r)); break;
+        case 4: if (at < n) b.erase(b.begin() + at); break;
+        case 5: {
+            if (at >= n) break;
+            size_t len = 1 + xrand(r) % 16;
+            if (at + len > n) len = n - at;
+            Bytes piece(b.begin() + at, b.begin() + at + len);
+            b.insert(b.begin() + 1 + xrand(r) % n, piece.begin(), piece.end());
+            break;
+        }
+        case 6: {
+            const Bytes& o = corpus[xrand(r) % corpus.size()];
+            if (o.size() < 2) break;
+            size_t from = 1 + xrand(r) % (o.size() - 1);
+            b.resize(at);
+            b.insert(b.end(), o.begin() + from, o.end());
+            break;
+        }
+        case 7: {
+            // 2, 4 or 8 bytes at a field boundary of the 8-aligned file formats (after the target byte)
+            size_t w = (size_t)2 << (xrand(r) % 3);
+            size_t pos = 1 + ((at - 1) & ~(w - 1));
+            uint64_t v = INTERESTING_WORDS[xrand(r) % (sizeof(INTERESTING_WORDS) / sizeof(INTERESTING_WORDS[0]))];
+            if (xrand(r) & 1) v = ~v + 1;   // and its negation
+            for (size_t i = 0; i < w && pos + i < n; i++) b[pos + i] = (uint8_t)(v >> (8 * i));
+            break;
+        }
+        }
+    }
+    if (b.size() > 8192) b.resize(8192);
+}
+
+int main(int argc, char** argv) {
+    uint64_t runs = 200000;
+    uint32_t seed_v = 1;
+    std::vector<std::string> dirs, files;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--make-corpus") == 0 && i + 1 < argc) return make_corpus(argv[i + 1]);
+        else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) runs = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed_v = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: fuzz_parsers [--runs n] [--seed s] corpus_dir... | input... | --make-corpus dir\n");
+            return 2;
+        } else {
+            struct stat st;
+            if (stat(argv[i], &st) != 0) {
+                fprintf(stderr, "%s: not found\n", argv[i]);
+                return 2;
+            }
+            (S_ISDIR(st.st_mode) ? dirs : files).push_back(argv[i]);
+        }
+    }
+
+    LLVMFuzzerInitialize(&argc, &argv);
+    for (int sig : {SIGABRT, SIGSEGV, SIGBUS, SIGFPE}) signal(sig, on_crash);
+
+    // single inputs: replay and stop
+    if (!files.empty()) {
+        for (const std::string& f : files) {
+            Bytes b;
+            if (!read_file(f, b)) return 2;
+            run_one(b);
+            fprintf(stderr, "[FUZZ] %s: ok\n", f.c_str());
+        }
+        return 0;
+    }
+
+    std::vector<Bytes> corpus;
+    for (const std::string& dir : dirs) {
+        DIR* dp = opendir(dir.c_str());
+        if (!dp) continue;
+        while (struct dirent* e = readdir(dp)) {
+            if (e->d_name[0] == '.') continue;
+            Bytes b;
+            if (read_file(dir + "/" + e->d_name, b) && !b.empty()) corpus.push_back(b);
+        }
+        closedir(dp);
+    }
+    if (corpus.empty()) {
+        std::vector<std::pair<std::string, Bytes>> seeds;
+        make_seeds(seeds);
+        for (auto& s : seeds) corpus.push_back(s.second);
+    }
+
+    uint64_t per_target[FUZZ_TARGET_COUNT] = {0};
+    for (const Bytes& b : corpus) {
+        run_one(b);
+        per_target[b[0] % FUZZ_TARGET_COUNT]++;
+    }
+
+    uint32_t r = seed_v | 1u;
+    for (uint64_t i = 0; i < runs; i++) {
+        Bytes b = corpus[xrand(r) % corpus.size()];
+        mutate(b, r, corpus);
+        run_one(b);
+        per_target[b[0] % FUZZ_TARGET_COUNT]++;
+    }
+
+    fprintf(stderr, "[FUZZ] %zu corpus inputs, %llu mutations, seed %u: no failures\n",
+            corpus.size(), (unsigned long long)runs, (unsigned)seed_v);
+    for (int t = 0; t < FUZZ_TARGET_COUNT; t++) {
+        fprintf(stderr, "[FUZZ]   %-9s %llu inputs\n", TARGET_NAMES[t], (unsigned long long)per_target[t]);
+    }
+    return 0;
+}
+
+#endif
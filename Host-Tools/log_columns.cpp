@@ -0,0 +1,378 @@
+// Parse captured firmware USB logs into columnar files.
+//
+// Build: g++ -O2 -std=c++17 -pthread -I../Motor-Control log_columns.cpp -o log_columns
+// Usage: log_columns [-j threads] -o <out_dir> <log files...>
+//
+// Files are mapped and scanned in parallel (one file per task) by a hand-written scanner that
+// never allocates per line. Lines are matched against the TEXT_FORMATS table:
+//   [<tag>] pulses=<u> dp=<u> FG_lvl=<d>                              monitor_fg_for_ms -> fg_monitor
+//   [FG_HAND] pulses=<u> dp=<u> lvl=<d> cmd=<f> cur=<f>               fg_hand_spin_test -> fg_hand
+// anything else is counted and skipped. New text formats are one table row; binary telemetry
+// goes in as another Source (detect + scan) that appends to the same tables.
+//
+// Output, per table: <out_dir>/<table>/<column>.bin (little-endian 4-byte u32/i32/f32, one
+// value per row, rows in input file order) and schema.txt ("<column> <type>" per line).
+// Every table has file (index into <out_dir>/files.txt) and line columns; tables with a free
+// tag have a tag column indexing <out_dir>/<table>/tags.txt. Load with e.g.
+// numpy.fromfile("fg_hand/cmd.bin", dtype="<f4").
+
+#include <atomic>
+#include <fcntl.h>
+#include <map>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+enum ColType : uint8_t { COL_U32, COL_I32, COL_F32 };
+
+static const char* col_type_name(ColType t) {
+    return t == COL_U32 ? "u32" : (t == COL_I32 ? "i32" : "f32");
+}
+
+static constexpr uint32_t FMT_KEYS_MAX = 8;
+
+struct TextFormat {
+    const char* table;
+    const char* tag;          // nullptr = any tag, stored in a tag column
+    uint32_t    nkeys;
+    const char* keys[FMT_KEYS_MAX];
+    ColType     types[FMT_KEYS_MAX];
+};
+
+// Most specific first: the first row that matches a line wins
+static const TextFormat TEXT_FORMATS[] = {
+    {"fg_hand",    "FG_HAND", 5, {"pulses", "dp", "lvl", "cmd", "cur"}, {COL_U32, COL_U32, COL_I32, COL_F32, COL_F32}},
+    {"fg_monitor", nullptr,   3, {"pulses", "dp", "FG_lvl"},            {COL_U32, COL_U32, COL_I32}},
+};
+
+static constexpr uint32_t FORMAT_COUNT = sizeof(TEXT_FORMATS) / sizeof(TEXT_FORMATS[0]);
+
+// ---- Per-file result ----
+
+struct TableRows {
+    std::vector<uint32_t> line;
+    std::vector<uint32_t> tag;                    // local tag ids (any-tag formats)
+    std::vector<uint32_t> cols[FMT_KEYS_MAX];     // raw 4-byte values
+};
+
+struct FileResult {
+    TableRows tables[FORMAT_COUNT];
+    std::vector<std::string> tags;                // local tag dictionary
+    uint64_t lines = 0;
+    uint64_t skipped = 0;
+    bool ok = false;
+};
+
+// ---- Scanner ----
+
+struct Cursor {
+    const char* p;
+    const char* end;
+};
+
+static bool scan_u32(Cursor& c, uint32_t* out) {
+    const char* p = c.p;
+    uint64_t v = 0;
+    if (p >= c.end || *p < '0' || *p > '9') return false;
+    while (p < c.end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (uint64_t)(*p++ - '0');
+        if (v > 0xFFFFFFFFull) return false;
+    }
+    c.p = p;
+    *out = (uint32_t)v;
+    return true;
+}
+
+static bool scan_i32(Cursor& c, int32_t* out) {
+    const char* start = c.p;
+    bool neg = (c.p < c.end && *c.p == '-');
+    if (neg) c.p++;
+    uint32_t u;
+    if (!scan_u32(c, &u) || u > (neg ? 0x80000000u : 0x7FFFFFFFu)) {
+        c.p = start;
+        return false;
+    }
+    *out = neg ? -(int32_t)(u - 1) - 1 : (int32_t)u;
+    return true;
+}
+
+// Plain decimal as printf("%.1f") writes it: [-]digits[.digits]
+static bool scan_f32(Cursor& c, float* out) {
+    const char* p = c.p;
+    bool neg = (p < c.end && *p == '-');
+    if (neg) p++;
+
+    double v = 0.0;
+    bool any = false;
+    while (p < c.end && *p >= '0' && *p <= '9') { v = v * 10.0 + (*p++ - '0'); any = true; }
+    if (p < c.end && *p == '.') {
+        p++;
+        double scale = 0.1;
+        while (p < c.end && *p >= '0' && *p <= '9') { v += (*p++ - '0') * scale; scale *= 0.1; any = true; }
+    }
+    if (!any) return false;
+
+    c.p = p;
+    *out = (float)(neg ? -v : v);
+    return true;
+}
+
+static void skip_spaces(Cursor& c) {
+    while (c.p < c.end && (*c.p == ' ' || *c.p == '\t')) c.p++;
+}
+
+// "key=" at the cursor
+static bool scan_key(Cursor& c, const char* key) {
+    size_t n = strlen(key);
+    if ((size_t)(c.end - c.p) < n + 1 || memcmp(c.p, key, n) != 0 || c.p[n] != '=') return false;
+    c.p += n + 1;
+    return true;
+}
+
+// Try one format on the rest of a line (after "[tag]"); values land in vals[]
+static bool match_format(const TextFormat& f, Cursor c, uint32_t* vals) {
+    for (uint32_t k = 0; k < f.nkeys; k++) {
+        skip_spaces(c);
+        if (!scan_key(c, f.keys[k])) return false;
+
+        bool ok;
+        if (f.types[k] == COL_U32) {
+            ok = scan_u32(c, &vals[k]);
+        } else if (f.types[k] == COL_I32) {
+            int32_t v = 0;
+            ok = scan_i32(c, &v);
+            memcpy(&vals[k], &v, 4);
+        } else {
+            float v = 0.0f;
+            ok = scan_f32(c, &v);
+            memcpy(&vals[k], &v, 4);
+        }
+        if (!ok) return false;
+    }
+    skip_spaces(c);
+    return c.p == c.end || *c.p == '\r';
+}
+
+static uint32_t local_tag_id(FileResult& r, const char* tag, size_t n) {
+    for (uint32_t i = 0; i < r.tags.size(); i++) {
+        if (r.tags[i].size() == n && memcmp(r.tags[i].data(), tag, n) == 0) return i;
+    }
+    r.tags.emplace_back(tag, n);
+    return (uint32_t)r.tags.size() - 1;
+}
+
+static void scan_text(const char* data, size_t len, FileResult& r) {
+    const char* p = data;
+    const char* end = data + len;
+    uint32_t line_no = 0;
+
+    while (p < end) {
+        const char* nl = (const char*)memchr(p, '\n', (size_t)(end - p));
+        const char* eol = nl ? nl : end;
+        line_no++;
+        r.lines++;
+
+        bool matched = false;
+        if (eol - p > 2 && *p == '[') {
+            const char* close = (const char*)memchr(p, ']', (size_t)(eol - p));
+            if (close) {
+                const char* tag = p + 1;
+                size_t tag_len = (size_t)(close - tag);
+                Cursor rest = {close + 1, eol};
+
+                for (uint32_t f = 0; f < FORMAT_COUNT && !matched; f++) {
+                    const TextFormat& fmt = TEXT_FORMATS[f];
+                    if (fmt.tag && (strlen(fmt.tag) != tag_len || memcmp(fmt.tag, tag, tag_len) != 0)) continue;
+
+                    uint32_t vals[FMT_KEYS_MAX];
+                    if (!match_format(fmt, rest, vals)) continue;
+
+                    TableRows& t = r.tables[f];
+                    t.line.push_back(line_no);
+                    if (!fmt.tag) t.tag.push_back(local_tag_id(r, tag, tag_len));
+                    for (uint32_t k = 0; k < fmt.nkeys; k++) t.cols[k].push_back(vals[k]);
+                    matched = true;
+                }
+            }
+        }
+        if (!matched) r.skipped++;
+
+        p = nl ? nl + 1 : end;
+    }
+}
+
+// ---- Sources ----
+// A source recognises a file from its first bytes and scans all of it into the tables.
+
+struct Source {
+    const char* name;
+    bool (*detect)(const char* data, size_t len);
+    void (*scan)(const char* data, size_t len, FileResult& r);
+};
+
+static bool detect_text(const char*, size_t) { return true; }
+
+// Binary formats first, text last (it accepts anything)
+static const Source SOURCES[] = {
+    {"text", detect_text, scan_text},
+};
+
+static void process_file(const char* path, FileResult& r) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return; }
+
+    size_t len = (size_t)st.st_size;
+    if (len == 0) { close(fd); r.ok = true; return; }
+
+    void* map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return;
+    madvise(map, len, MADV_SEQUENTIAL);
+
+    const char* data = (const char*)map;
+    for (const Source& s : SOURCES) {
+        if (s.detect(data, len)) {
+            s.scan(data, len, r);
+            break;
+        }
+    }
+
+    munmap(map, len);
+    r.ok = true;
+}
+
+// ---- Output ----
+
+static bool write_column(const std::string& dir, const char* name, const std::vector<const std::vector<uint32_t>*>& parts,
+                         const std::vector<uint32_t>* add_per_part = nullptr) {
+    std::string path = dir + "/" + name + ".bin";
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+
+    for (size_t i = 0; i < parts.size(); i++) {
+        const std::vector<uint32_t>& v = *parts[i];
+        if (!add_per_part) {
+            fwrite(v.data(), 4, v.size(), f);
+            continue;
+        }
+        // constant column (file index) for this part
+        std::vector<uint32_t> fill(v.size(), (*add_per_part)[i]);
+        fwrite(fill.data(), 4, fill.size(), f);
+    }
+    return fclose(f) == 0;
+}
+
+int main(int argc, char** argv) {
+    unsigned threads = std::thread::hardware_concurrency();
+    const char* out_dir = nullptr;
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) threads = (unsigned)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) out_dir = argv[++i];
+        else files.push_back(argv[i]);
+    }
+    if (!out_dir || files.empty()) {
+        fprintf(stderr, "usage: log_columns [-j threads] -o <out_dir> <log files...>\n");
+        return 2;
+    }
+    if (threads == 0) threads = 1;
+
+    std::vector<FileResult> results(files.size());
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back([&] {
+            for (size_t i; (i = next.fetch_add(1)) < files.size();) process_file(files[i], results[i]);
+        });
+    }
+    for (std::thread& t : pool) t.join();
+
+    mkdir(out_dir, 0755);
+    FILE* ff = fopen((std::string(out_dir) + "/files.txt").c_str(), "w");
+    if (!ff) { fprintf(stderr, "cannot write to %s\n", out_dir); return 1; }
+
+    uint64_t lines = 0, skipped = 0;
+    uint32_t failed = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        fprintf(ff, "%s\n", files[i]);
+        lines += results[i].lines;
+        skipped += results[i].skipped;
+        if (!results[i].ok) { failed++; fprintf(stderr, "cannot read %s\n", files[i]); }
+    }
+    fclose(ff);
+
+    for (uint32_t f = 0; f < FORMAT_COUNT; f++) {
+        const TextFormat& fmt = TEXT_FORMATS[f];
+        std::string dir = std::string(out_dir) + "/" + fmt.table;
+        mkdir(dir.c_str(), 0755);
+
+        std::vector<const std::vector<uint32_t>*> line_parts;
+        std::vector<uint32_t> file_ids;
+        uint64_t rows = 0;
+        for (size_t i = 0; i < results.size(); i++) {
+            line_parts.push_back(&results[i].tables[f].line);
+            file_ids.push_back((uint32_t)i);
+            rows += results[i].tables[f].line.size();
+        }
+
+        bool ok = write_column(dir, "file", line_parts, &file_ids) && write_column(dir, "line", line_parts);
+
+        FILE* sf = fopen((dir + "/schema.txt").c_str(), "w");
+        if (!sf) return 1;
+        fprintf(sf, "file u32\nline u32\n");
+
+        // free tags: remap file-local ids onto one dictionary
+        if (!fmt.tag) {
+            std::map<std::string, uint32_t> dict;
+            std::vector<std::string> names;
+            std::vector<std::vector<uint32_t>> remapped(results.size());
+            std::vector<const std::vector<uint32_t>*> tag_parts;
+
+            for (size_t i = 0; i < results.size(); i++) {
+                for (uint32_t local : results[i].tables[f].tag) {
+                    const std::string& name = results[i].tags[local];
+                    auto it = dict.find(name);
+                    if (it == dict.end()) {
+                        it = dict.emplace(name, (uint32_t)names.size()).first;
+                        names.push_back(name);
+                    }
+                    remapped[i].push_back(it->second);
+                }
+                tag_parts.push_back(&remapped[i]);
+            }
+            ok = ok && write_column(dir, "tag", tag_parts);
+            fprintf(sf, "tag u32\n");
+
+            FILE* tf = fopen((dir + "/tags.txt").c_str(), "w");
+            if (!tf) return 1;
+            for (const std::string& n : names) fprintf(tf, "%s\n", n.c_str());
+            fclose(tf);
+        }
+
+        for (uint32_t k = 0; k < fmt.nkeys; k++) {
+            std::vector<const std::vector<uint32_t>*> parts;
+            for (size_t i = 0; i < results.size(); i++) parts.push_back(&results[i].tables[f].cols[k]);
+            ok = ok && write_column(dir, fmt.keys[k], parts);
+            fprintf(sf, "%s %s\n", fmt.keys[k], col_type_name(fmt.types[k]));
+        }
+        fclose(sf);
+
+        if (!ok) { fprintf(stderr, "write failed in %s\n", dir.c_str()); return 1; }
+        printf("[LOG_COLUMNS] %s rows=%llu\n", fmt.table, (unsigned long long)rows);
+    }
+
+    printf("[LOG_COLUMNS] files=%zu lines=%llu skipped=%llu unreadable=%u\n",
+           files.size(), (unsigned long long)lines, (unsigned long long)skipped, failed);
+    return failed ? 1 : 0;
+}
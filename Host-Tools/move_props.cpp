@@ -0,0 +1,296 @@
+// Property checks for the move helpers in control_law.h, over seeded random inputs.
+// Each property is checked on random cases and on the edges that matter (dt <= 0, rates that are
+// zero / negative / NaN, moves too short for padding, pulse counts near 2^32); the first
+// counterexample is printed with the seed that reproduces it.
+//
+// Build: g++ -O2 -std=c++17 -I../Motor-Control move_props.cpp -o move_props
+// Usage: move_props [-n cases] [--seed s]
+//
+//   slew      slew_step: never leaves [current, target], approaches monotonically, steps at most
+//             rate * dt (plus the rounding of the sum), lands on target exactly, and leaves current
+//             alone for dt <= 0 / rate <= 0 / NaN; through slew_clamp_target / slew_clamp_rate any
+//             input gives a duty in 0..100
+//   complete  slew_step repeated reaches the target exactly within ceil(|error| / (step - res)) + 1
+//             steps, res being the float resolution at 100 % (each sum may round that much short);
+//             for steps above it only, finer ones are the job of slew_update, which accumulates dt
+//   distance  pulses_for_meters: rejects NaN, negative and over-capacity distances, rounds to the
+//             nearest pulse otherwise
+//   pad       move_pad_pulses: never more than asked, start and end padding never overlap, kept
+//             as asked whenever it fits
+//   profile   move_duty_open_loop over a whole move: only padding or cruise duty, padding over
+//             exactly the first and last pad pulses, padding (not cruise) once past the target
+//   stall     stall_min_pulses: 0 below 15 %, non-decreasing in duty, never more than a drum at
+//             that duty makes in the default stall window on any variant's nominal plant
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "winch_variants.h"
+#include "winch_model.h"
+#include "control_law.h"
+
+static const float STALL_WINDOW_S = 0.5f;    // stall_window_us default
+static const float DUTY_RES       = 100.0f * FLT_EPSILON;   // float resolution at 100 %
+static const float MIN_SLEW_STEP  = 1e-4f;                  // well above it
+
+static uint32_t g_seed;
+
+static uint32_t xrand(uint32_t& s) {
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    return s;
+}
+
+static float frand(uint32_t& s) {
+    return (float)(xrand(s) >> 8) / 16777216.0f;
+}
+
+static float uni(uint32_t& s, float lo, float hi) {
+    return lo + (hi - lo) * frand(s);
+}
+
+// Log-uniform over [lo, hi], lo > 0
+static float logu(uint32_t& s, float lo, float hi) {
+    return expf(uni(s, logf(lo), logf(hi)));
+}
+
+// Duty-like value: mostly in range, sometimes just outside, now and then not finite
+static float any_duty(uint32_t& s) {
+    switch (xrand(s) % 10) {
+    case 0:  return uni(s, -50.0f, 0.0f);
+    case 1:  return uni(s, 100.0f, 200.0f);
+    case 2:  return (xrand(s) & 1) ? NAN : ((xrand(s) & 1) ? INFINITY : -INFINITY);
+    case 3:  return (float)(xrand(s) % 3) * 50.0f;   // 0, 50, 100 exactly
+    default: return uni(s, 0.0f, 100.0f);
+    }
+}
+
+// Pulse count with the 32-bit edges well represented
+static uint32_t any_pulses(uint32_t& s) {
+    switch (xrand(s) % 6) {
+    case 0:  return xrand(s) % 4;
+    case 1:  return 0xFFFFFFFFu - xrand(s) % 4;
+    case 2:  return 0x80000000u + (xrand(s) % 5) - 2;
+    case 3:  return xrand(s);
+    default: return xrand(s) % 20000;
+    }
+}
+
+#define PROP(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            printf("[PROP] FAIL %s (seed %u): %s\n  ", name, (unsigned)g_seed, #cond); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            return false; \
+        } \
+    } while (0)
+
+// ---- slew ----
+
+static bool check_slew(uint32_t& r, uint32_t n) {
+    const char* name = "slew";
+    for (uint32_t i = 0; i < n; i++) {
+        float cur = slew_clamp_target(any_duty(r));
+        float raw_target = any_duty(r);
+        float tgt = slew_clamp_target(raw_target);
+        float raw_rate = (xrand(r) % 8 == 0) ? any_duty(r) - 50.0f : logu(r, 0.01f, 10000.0f);
+        float rate = slew_clamp_rate(raw_rate);
+        float dt = (xrand(r) % 8 == 0) ? -uni(r, 0.0f, 0.1f) : logu(r, 1e-6f, 1.0f);
+
+        PROP(tgt >= 0.0f && tgt <= 100.0f, "target %g -> %g", (double)raw_target, (double)tgt);
+        PROP(rate > 0.0f, "rate %g -> %g", (double)raw_rate, (double)rate);
+
+        float next = slew_step(cur, tgt, rate, dt);
+        float max_step = rate * dt;
+        float lo = fminf(cur, tgt), hi = fmaxf(cur, tgt);
+
+        if (!(max_step > 0.0f)) {
+            PROP(next == cur, "cur %g tgt %g rate %g dt %g -> %g", (double)cur, (double)tgt, (double)rate, (double)dt, (double)next);
+            continue;
+        }
+        PROP(next >= lo && next <= hi, "cur %g tgt %g step %g -> %g", (double)cur, (double)tgt, (double)max_step, (double)next);
+        PROP(fabsf(tgt - next) <= fabsf(tgt - cur), "cur %g tgt %g step %g -> %g", (double)cur, (double)tgt, (double)max_step, (double)next);
+        PROP(fabsf(next - cur) <= max_step + FLT_EPSILON * fmaxf(fabsf(cur), fabsf(next)), "cur %g tgt %g step %g -> %g", (double)cur, (double)tgt, (double)max_step, (double)next);
+        if (fabsf(tgt - cur) <= max_step) {
+            PROP(next == tgt, "cur %g tgt %g step %g -> %g", (double)cur, (double)tgt, (double)max_step, (double)next);
+        }
+
+        // the raw target gives the same step as its clamp (what slew_set_target stores)
+        PROP(slew_step(cur, slew_clamp_target(raw_target), rate, dt) == next, "raw target %g", (double)raw_target);
+    }
+    return true;
+}
+
+static bool check_complete(uint32_t& r, uint32_t n) {
+    const char* name = "complete";
+    for (uint32_t i = 0; i < n; i++) {
+        float cur = slew_clamp_target(any_duty(r));
+        float tgt = slew_clamp_target(any_duty(r));
+        float rate = logu(r, 1.0f, 5000.0f);
+        float dt = logu(r, MIN_SLEW_STEP / rate, 0.05f);
+        float step = rate * dt;
+        if (!(step >= MIN_SLEW_STEP)) continue;
+
+        uint32_t limit = (uint32_t)ceilf(fabsf(tgt - cur) / (step - DUTY_RES)) + 1;
+        if (limit > 100000) continue;
+
+        float x = cur;
+        uint32_t k = 0;
+        while (x != tgt && k < limit) {
+            float nx = slew_step(x, tgt, rate, dt);
+            PROP(fabsf(tgt - nx) < fabsf(tgt - x), "stuck at %g toward %g (step %g)", (double)x, (double)tgt, (double)step);
+            x = nx;
+            k++;
+        }
+        PROP(x == tgt, "from %g to %g at %g per step: %g after %u steps", (double)cur, (double)tgt, (double)step, (double)x, (unsigned)k);
+    }
+    return true;
+}
+
+// ---- distance ----
+
+static bool check_distance(uint32_t& r, uint32_t n) {
+    const char* name = "distance";
+    for (uint32_t i = 0; i < n; i++) {
+        WinchDerived w = winch_derive(xrand(r) % WINCH_VARIANT_COUNT);
+        float max_m = w.v->max_line_m;
+        float ppm = w.pulses_per_meter;
+
+        float m;
+        switch (xrand(r) % 6) {
+        case 0:  m = -uni(r, 0.0f, 10.0f); break;
+        case 1:  m = max_m + logu(r, 1e-4f, 1e6f); break;
+        case 2:  m = (xrand(r) & 1) ? NAN : INFINITY; break;
+        case 3:  m = (xrand(r) & 1) ? 0.0f : max_m; break;
+        default: m = uni(r, 0.0f, max_m); break;
+        }
+
+        uint32_t pulses = 0xDEADBEEF;
+        bool ok = pulses_for_meters(m, ppm, max_m, &pulses);
+        bool valid = (m >= 0.0f && m <= max_m);
+
+        PROP(ok == valid, "%g m of %g m -> %s", (double)m, (double)max_m, ok ? "accepted" : "rejected");
+        if (!ok) {
+            PROP(pulses == 0xDEADBEEF, "rejected %g m but wrote %u", (double)m, (unsigned)pulses);
+            continue;
+        }
+        PROP(fabsf((float)pulses - m * ppm) <= 0.5f + 1e-3f * m * ppm, "%g m at %g ppm -> %u", (double)m, (double)ppm, (unsigned)pulses);
+    }
+    return true;
+}
+
+// ---- padding and the open-loop profile ----
+
+static bool check_pad(uint32_t& r, uint32_t n) {
+    const char* name = "pad";
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t target = any_pulses(r);
+        uint32_t asked = (xrand(r) % 4 == 0) ? any_pulses(r) : (target / 2 + (xrand(r) % 5) - 2);
+        uint32_t pad = move_pad_pulses(target, asked);
+
+        PROP(pad <= asked, "target %u asked %u -> %u", (unsigned)target, (unsigned)asked, (unsigned)pad);
+        PROP((uint64_t)pad * 2 <= target, "target %u asked %u -> %u", (unsigned)target, (unsigned)asked, (unsigned)pad);
+        if ((uint64_t)asked * 2 < target) {
+            PROP(pad == asked, "target %u asked %u -> %u", (unsigned)target, (unsigned)asked, (unsigned)pad);
+        } else {
+            PROP(pad == target / 2, "target %u asked %u -> %u", (unsigned)target, (unsigned)asked, (unsigned)pad);
+        }
+    }
+    return true;
+}
+
+static bool check_profile(uint32_t& r, uint32_t n) {
+    const char* name = "profile";
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t target = any_pulses(r);
+        uint32_t pad = move_pad_pulses(target, any_pulses(r));
+        float cruise = uni(r, 1.0f, 100.0f);
+        float padding = uni(r, 1.0f, 100.0f);
+        if (cruise == padding) continue;
+
+        // the boundaries, and random points in each part of the move
+        uint32_t pts[10] = {0, pad - (pad > 0), pad, target - pad - (target - pad > 0), target - pad,
+                            target - (target > 0), target, target + 1, 0xFFFFFFFFu, 0};
+        pts[9] = (target > 0) ? xrand(r) % target : 0;
+
+        for (uint32_t now : pts) {
+            float d = move_duty_open_loop(now, target, pad, cruise, padding);
+            uint32_t remaining = (now < target) ? target - now : 0;
+            bool padded = (now < pad) || (remaining < pad);
+
+            PROP(d == cruise || d == padding, "now %u target %u pad %u -> %g", (unsigned)now, (unsigned)target, (unsigned)pad, (double)d);
+            PROP(d == (padded ? padding : cruise), "now %u target %u pad %u -> %g (padding %g cruise %g)",
+                 (unsigned)now, (unsigned)target, (unsigned)pad, (double)d, (double)padding, (double)cruise);
+            if (now >= target && pad > 0) {
+                PROP(d == padding, "past the target: now %u target %u pad %u -> %g", (unsigned)now, (unsigned)target, (unsigned)pad, (double)d);
+            }
+        }
+    }
+    return true;
+}
+
+// ---- stall threshold ----
+
+static bool check_stall(uint32_t& r, uint32_t n) {
+    const char* name = "stall";
+    for (uint32_t i = 0; i < n; i++) {
+        float a = slew_clamp_target(any_duty(r));
+        float b = slew_clamp_target(any_duty(r));
+        if (a > b) { float t = a; a = b; b = t; }
+
+        PROP(stall_min_pulses(a) <= stall_min_pulses(b), "%g%% -> %u, %g%% -> %u",
+             (double)a, (unsigned)stall_min_pulses(a), (double)b, (unsigned)stall_min_pulses(b));
+        if (a < 15.0f) PROP(stall_min_pulses(a) == 0, "%g%% -> %u", (double)a, (unsigned)stall_min_pulses(a));
+
+        // a healthy drum on the nominal plant always beats the threshold
+        WinchDerived w = winch_derive(xrand(r) % WINCH_VARIANT_COUNT);
+        PlantParams p = plant_default_params(w.full_speed_pps, w.pulses_per_meter);
+        float made = speed_for_duty(p, b) * STALL_WINDOW_S;
+        PROP(made >= (float)stall_min_pulses(b), "%s at %g%%: %g pulses per window, threshold %u",
+             w.v->name, (double)b, (double)made, (unsigned)stall_min_pulses(b));
+    }
+    return true;
+}
+
+struct Property {
+    const char* name;
+    bool (*check)(uint32_t& r, uint32_t n);
+    uint32_t scale;   // cases relative to -n, in 1/20ths
+};
+
+static const Property PROPS[] = {
+    {"slew",     check_slew,     80},
+    {"complete", check_complete, 1},    // each case runs a whole ramp
+    {"distance", check_distance, 40},
+    {"pad",      check_pad,      80},
+    {"profile",  check_profile,  40},
+    {"stall",    check_stall,    40},
+};
+
+int main(int argc, char** argv) {
+    uint32_t n = 100000;
+    uint32_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) n = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else {
+            fprintf(stderr, "usage: move_props [-n cases] [--seed s]\n");
+            return 2;
+        }
+    }
+
+    int failed = 0;
+    for (const Property& p : PROPS) {
+        g_seed = seed;
+        uint32_t r = seed | 1u;
+        uint32_t cases = (uint32_t)((uint64_t)n * p.scale / 20);
+        if (p.check(r, cases)) printf("[PROP] %-8s %u cases ok\n", p.name, (unsigned)cases);
+        else failed++;
+    }
+    printf("[PROP] seed %u: %s\n", (unsigned)seed, failed ? "FAILED" : "all properties hold");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+// Simulated rangefinder for lower_to_height_m (Motor-Control/rangefinder.h).
+//
+// Build: g++ -O2 -std=c++17 -I../Motor-Control range_sim.cpp -o range_sim
+// Usage: range_sim [start_h_m] [target_h_m] [speed_pct]
+//        range_sim --emit <start_h_m> <descent_mps>  > /dev/ttyUSB0
+//
+// Default mode runs the firmware's descent (fusion, approach profile, brake-coast stop) against
+// the winch plant, with a noisy sensor that drops frames, sees outliers and a line that
+// stretches 1 %, all passed through the real frame encoder/parser. Exit code 1 unless the
+// payload stops within 5 cm of the target.
+// --emit writes TFmini frames at 100 Hz for a payload descending at a fixed rate, to feed the
+// firmware's UART through a USB-serial adapter.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "winch_variants.h"
+#include "winch_model.h"
+#include "control_law.h"
+#include "autotune.h"
+#include "rangefinder.h"
+
+struct Sensor {
+    float    noise_m;
+    float    dropout;    // probability a frame is lost
+    float    outlier;    // probability it reads something under the payload instead
+    uint32_t seed;
+};
+
+static float frand(uint32_t& s) {
+    s = s * 1664525u + 1013904223u;
+    return (float)(s >> 8) / 16777216.0f;
+}
+
+static float gauss(uint32_t& s) {
+    float u1 = frand(s) + 1e-7f, u2 = frand(s);
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+// One sensor frame for the true height, or 0 bytes if it was dropped
+static uint32_t sensor_frame(Sensor& s, float h_true, uint8_t out[RANGE_FRAME_LEN]) {
+    if (frand(s.seed) < s.dropout) return 0;
+
+    float d = h_true + s.noise_m * gauss(s.seed);
+    if (frand(s.seed) < s.outlier) d *= 0.3f;
+    range_encode_frame(out, d, 1000);
+    return RANGE_FRAME_LEN;
+}
+
+static int emit(float h0, float rate_mps) {
+    const float dt = 0.01f;
+    Sensor s = {0.01f, 0.0f, 0.0f, 1};
+    uint8_t f[RANGE_FRAME_LEN];
+
+    for (float h = h0; h > 0.0f; h -= rate_mps * dt) {
+        if (sensor_frame(s, h, f)) fwrite(f, 1, RANGE_FRAME_LEN, stdout);
+        fflush(stdout);
+        usleep((useconds_t)(dt * 1e6f));
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--emit") == 0) {
+        if (argc < 4) return 2;
+        return emit(strtof(argv[2], nullptr), strtof(argv[3], nullptr));
+    }
+
+    float h0     = (argc > 1) ? strtof(argv[1], nullptr) : 6.0f;
+    float target = (argc > 2) ? strtof(argv[2], nullptr) : 0.5f;
+    float speed  = (argc > 3) ? strtof(argv[3], nullptr) : 100.0f;
+
+    WinchDerived w = winch_derive(WINCH_VARIANT);
+    PlantParams p = plant_default_params(w.full_speed_pps, w.pulses_per_meter);
+    const float ppm = p.pulses_per_meter;
+
+    // defaults of the matching parameters
+    const float slew_rate = 200.0f, brake_rate = 400.0f, decel = 0.5f, creep = 0.03f;
+    const float stretch = 1.01f;
+
+    Sensor sensor = {0.015f, 0.05f, 0.01f, 12345};
+    RangeParser parser = {};
+    HeightFusion fusion;
+    height_reset(fusion);
+    height_correct(fusion, h0);
+
+    PlantState drum = {0.0f, 0.0f};
+    const float dt = 0.001f;
+    float duty = 0.0f, duty_target = 0.0f;
+    float v_max = speed_for_duty(p, speed) / ppm;
+    float ctrl_t = 0.0f, sensor_t = 0.0f, seen = 0.0f, t = 0.0f;
+    uint32_t rejects = 0;
+    bool stopping = false;
+
+    for (; t < 120.0f; t += dt) {
+        float h_true = h0 - drum.pos_pulses / ppm * stretch;
+
+        if (sensor_t >= 0.01f) {
+            sensor_t = 0.0f;
+            uint8_t f[RANGE_FRAME_LEN];
+            uint32_t n = sensor_frame(sensor, h_true, f);
+            for (uint32_t i = 0; i < n; i++) {
+                float z;
+                if (range_parse_byte(parser, f[i], &z) && !height_correct(fusion, z)) rejects++;
+            }
+        }
+
+        if (!stopping && ctrl_t >= SPEED_LOOP_DT_S) {
+            ctrl_t = 0.0f;
+            float now = floorf(drum.pos_pulses);
+            height_predict(fusion, (now - seen) / ppm);
+            seen = now;
+
+            float stop_m = tune_brake_distance_pulses(p, duty, brake_rate) / ppm;
+            if (fusion.h - stop_m <= target) {
+                stopping = true;
+                duty_target = 0.0f;
+            } else {
+                float v = descent_speed_mps(fusion.h, target, stop_m, v_max, decel, creep);
+                duty_target = duty_for_speed(p, v * ppm);
+            }
+        }
+
+        duty = slew_step(duty, duty_target, stopping ? brake_rate : slew_rate, dt);
+        plant_step(drum, p, duty, dt);
+        ctrl_t += dt;
+        sensor_t += dt;
+
+        if (stopping && duty == 0.0f && drum.speed_pps < 1.0f) break;
+    }
+
+    float h_final = h0 - drum.pos_pulses / ppm * stretch;
+    float err = h_final - target;
+    float t_full = (h0 - target) / (speed_for_duty(p, speed) / ppm);
+
+    printf("[RANGE_SIM] %s start=%.2f m target=%.2f m speed=%.0f%%\n", w.v->name, h0, target, speed);
+    printf("[RANGE_SIM] final=%.3f m error=%+.3f m time=%.2f s (%.2f s at full speed) fused=%.3f rejects=%u\n",
+           h_final, err, t, t_full, fusion.h, rejects);
+
+    bool ok = fabsf(err) < 0.05f;
+    printf("[RANGE_SIM] %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// Tension input: reads mid-scale (no load cell), as an unconnected pin does.
+
+#include "pico/stdlib.h"
+
+void adc_init();
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint16_t adc_read();
@@ -0,0 +1,16 @@
+#pragma once
+
+// Flash is a host buffer (or a mapped image file with --flash) read through XIP_BASE.
+// Programming can only clear bits, as on the real part.
+
+#include "pico/stdlib.h"
+
+#define FLASH_PAGE_SIZE       (1u << 8)
+#define FLASH_SECTOR_SIZE     (1u << 12)
+#define PICO_FLASH_SIZE_BYTES (2u * 1024u * 1024u)
+
+extern uint8_t* sitl_flash;
+#define XIP_BASE ((uintptr_t)sitl_flash)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count);
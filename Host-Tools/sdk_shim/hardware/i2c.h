@@ -0,0 +1,15 @@
+#pragma once
+
+// No I2C devices: every transfer fails, as with nothing on the bus.
+
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t* const sitl_i2c0;
+extern i2c_inst_t* const sitl_i2c1;
+#define i2c0 sitl_i2c0
+#define i2c1 sitl_i2c1
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate);
+int i2c_write_timeout_us(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop, uint timeout_us);
+int i2c_read_timeout_us(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop, uint timeout_us);
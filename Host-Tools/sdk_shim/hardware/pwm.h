@@ -0,0 +1,11 @@
+#pragma once
+
+// PWM on the motor pin drives the simulated plant; one slice/channel is enough.
+
+#include "pico/stdlib.h"
+
+uint pwm_gpio_to_slice_num(uint gpio);
+uint pwm_gpio_to_channel(uint gpio);
+void pwm_set_wrap(uint slice, uint16_t wrap);
+void pwm_set_chan_level(uint slice, uint chan, uint16_t level);
+void pwm_set_enabled(uint slice, bool enabled);
@@ -0,0 +1,8 @@
+#pragma once
+
+// Masking defers FG edges until the matching restore, in order.
+
+#include "pico/stdlib.h"
+
+uint32_t save_and_disable_interrupts();
+void restore_interrupts(uint32_t status);
@@ -0,0 +1,15 @@
+#pragma once
+
+// UART1 carries the simulated TFmini frames when the host runs with --height.
+
+#include "pico/stdlib.h"
+
+typedef struct uart_inst uart_inst_t;
+extern uart_inst_t* const sitl_uart0;
+extern uart_inst_t* const sitl_uart1;
+#define uart0 sitl_uart0
+#define uart1 sitl_uart1
+
+uint uart_init(uart_inst_t* uart, uint baudrate);
+bool uart_is_readable(uart_inst_t* uart);
+char uart_getc(uart_inst_t* uart);
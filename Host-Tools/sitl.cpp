@@ -0,0 +1,123 @@
+// The whole firmware as a Linux process: USB stdio on a pseudo-terminal, the winch on the plant model.
+//
+// Build: g++ -O2 -std=c++17 -Isdk_shim -I../Motor-Control sitl.cpp -o sitl
+// Usage: sitl [--variant n] [--rate x] [--slip m/s] [--height m] [--flash image] [--stdio]
+//
+// Motor-Control.cpp is compiled unchanged against the SDK stand-ins in sdk_shim/ (its main() becomes
+// firmware_main()). On start the process prints the slave side of its pty on stderr, e.g.
+//   [SITL] pty /dev/pts/7
+// and ground software talks to that exactly as to the USB CDC port: commands in, log lines and
+// telemetry out. --stdio uses the process's own stdin/stdout instead, for scripted runs
+// ("sitl --stdio < params.txt"). With no reader on the pty, output is dropped as USB stdio does.
+//
+// Hardware (sitl.h, shared with the tools that run firmware functions):
+//   PWM duty and the DIR pin drive the first-order plant (winch_model.h) of --variant, with the
+//     variant's rated speed; each FG pulse of drum travel is a call of the GPIO callback.
+//   --slip pays line out at this speed whenever the duty is below the deadzone: the payload
+//     backdriving the drum, which the hold loop has to catch.
+//   --height puts a TFmini-style rangefinder (range_source 1) on UART1 at this height above the
+//     ground with the line wound in; it reports height minus line out at 100 Hz.
+//   Flash is 2 MB of RAM, or a file mapped with --flash so tune, parameters and counters survive
+//     restarts. The tension ADC reads mid-scale; I2C has no devices.
+// The clock runs from the host's monotonic clock times --rate (default 1, real time).
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <termios.h>
+#include "sitl.h"
+
+// ---- host side ----
+
+static bool flash_open(const char* path) {
+    if (!path) {
+        sitl_flash = (uint8_t*)malloc(PICO_FLASH_SIZE_BYTES);
+        if (!sitl_flash) return false;
+        memset(sitl_flash, 0xFF, PICO_FLASH_SIZE_BYTES);
+        return true;
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+    off_t size = lseek(fd, 0, SEEK_END);
+    if (size < (off_t)PICO_FLASH_SIZE_BYTES) {
+        // new (or short) image: erased flash
+        static uint8_t ff[4096];
+        memset(ff, 0xFF, sizeof(ff));
+        for (off_t o = size; o < (off_t)PICO_FLASH_SIZE_BYTES; o += (off_t)sizeof(ff)) {
+            size_t n = sizeof(ff);
+            if (o + (off_t)n > (off_t)PICO_FLASH_SIZE_BYTES) n = (size_t)(PICO_FLASH_SIZE_BYTES - o);
+            if (pwrite(fd, ff, n, o) != (ssize_t)n) { close(fd); return false; }
+        }
+    }
+    void* m = mmap(nullptr, PICO_FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) return false;
+    sitl_flash = (uint8_t*)m;
+    return true;
+}
+
+// Pseudo-terminal in raw mode; stdout writes into the master, commands are read from it
+static bool pty_open() {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return false;
+    const char* name = ptsname(master);
+    if (!name) return false;
+
+    // hold the slave open so the master never sees a hangup between clients
+    int slave = open(name, O_RDWR | O_NOCTTY);
+    if (slave < 0) return false;
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    if (dup2(master, STDOUT_FILENO) < 0) return false;
+    g_sitl.in_fd = master;
+
+    fprintf(stderr, "[SITL] pty %s\n", name);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    uint32_t variant = WINCH_VARIANT;
+    const char* flash_path = nullptr;
+    bool use_stdio = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--variant") == 0 && i + 1 < argc) variant = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) g_sitl.rate = strtod(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--slip") == 0 && i + 1 < argc) g_sitl.slip_mps = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--height") == 0 && i + 1 < argc) g_sitl.height_m = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--flash") == 0 && i + 1 < argc) flash_path = argv[++i];
+        else if (strcmp(argv[i], "--stdio") == 0) use_stdio = true;
+        else {
+            fprintf(stderr, "usage: sitl [--variant n] [--rate x] [--slip m/s] [--height m] [--flash image] [--stdio]\n");
+            return 2;
+        }
+    }
+    if (!(g_sitl.rate > 0.0) || !(g_sitl.slip_mps >= 0.0f) || !(g_sitl.height_m >= 0.0f)) {
+        fprintf(stderr, "bad --rate, --slip or --height\n");
+        return 2;
+    }
+
+    if (!flash_open(flash_path)) {
+        fprintf(stderr, "cannot open flash image %s\n", flash_path ? flash_path : "(ram)");
+        return 1;
+    }
+    if (use_stdio) {
+        g_sitl.in_fd = STDIN_FILENO;
+    } else if (!pty_open()) {
+        fprintf(stderr, "cannot open a pseudo-terminal\n");
+        return 1;
+    }
+    setvbuf(stdout, nullptr, _IONBF, 0);
+
+    g_sitl.w = winch_derive(variant);
+    g_sitl.p = plant_default_params(g_sitl.w.full_speed_pps, g_sitl.w.pulses_per_meter);
+    fprintf(stderr, "[SITL] variant %s, rate %.1fx, slip %.3f m/s, rangefinder %s\n",
+            g_sitl.w.v->name, g_sitl.rate, (double)g_sitl.slip_mps, g_sitl.height_m > 0.0f ? "uart" : "none");
+
+    g_sitl.host_t0_us = host_us();
+    return firmware_main();
+}
@@ -0,0 +1,460 @@
+#pragma once
+
+// The firmware on a simulated winch: shared by sitl and the tools that run the firmware's own
+// move and hold functions (ctrl_bench, fault_sim, cycle_opt). Build with -Isdk_shim -I../Motor-Control.
+//
+// Motor-Control.cpp is compiled unchanged against the SDK stand-ins in sdk_shim/ (its main()
+// becomes firmware_main()); everything the SDK would do happens here.
+//
+// Clock: real time for sitl (the host's monotonic clock times g_sitl.rate), or lockstep (rate 0)
+// for the tools. In lockstep, time only moves while the firmware waits: a pass of a busy loop
+// (tight_loop_contents) costs SITL_SPIN_US, a USB poll SITL_POLL_US, a sleep its length, a WFE
+// until the next FG edge. Runs are then deterministic and as fast as the host allows. Either
+// way the plant is advanced whenever the firmware looks at the time, in steps of at most 1 ms.
+//
+// World: PWM duty and the DIR pin drive g_sitl.world. The default is the first-order plant
+// (winch_model.h) of the variant with g_sitl.slip_mps of payload backdrive below the deadzone;
+// a tool puts its own in (true plant, load, faults). Each FG pulse of drum travel calls the
+// registered GPIO callback with the clock pinned to the edge's own time; edges that arrive while
+// interrupts are masked are delivered, in order, at the restore. With g_sitl.height_m set, a
+// TFmini-style rangefinder on UART1 reports height minus line out at 100 Hz.
+//
+// The firmware keeps its state in globals, so a process is one winch. sitl_fork_runs() runs each
+// scenario in a forked copy of the booted firmware, so every run starts from the same state.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define main firmware_main
+#include "../Motor-Control/Motor-Control.cpp"
+#undef main
+
+static const double SITL_STEP_US  = 1000.0;   // longest plant step
+static const double SITL_RANGE_US = 10000.0;  // TFmini frame period
+static const double SITL_SPIN_US  = 50.0;     // per busy-wait pass: host time given up, or lockstep time taken
+static const double SITL_POLL_US  = 2.0;      // lockstep time of a USB poll
+
+// What the firmware drives. step() runs the winch for dt_s at the applied PWM duty and DIR pin
+// and returns the line speed (pulses/s, + paying out); the core turns that into FG edges.
+struct SitlWorld {
+    void* ctx;
+    double (*step)(void* ctx, float duty_pct, bool dir_ccw, double t_s, double dt_s);
+    // FG edges one pulse of drum travel at t_s raises: 1, 0 (lost) or 2 (doubled); null = 1
+    uint32_t (*edges)(void* ctx, double t_s);
+    // spurious FG edges in the step ending at t_s; null = none
+    uint32_t (*noise)(void* ctx, double t_s, double dt_s);
+};
+
+static double sitl_plant_step(void* ctx, float duty, bool dir_ccw, double t_s, double dt_s);
+
+static struct {
+    // configuration
+    double   rate = 1.0;         // 0 = lockstep
+    float    slip_mps = 0.0f;
+    float    height_m = 0.0f;    // 0 = no rangefinder
+    int      in_fd = 0;          // USB stdio input; < 0 = nothing connected
+    PlantParams p;
+    WinchDerived w;
+    SitlWorld world = {nullptr, sitl_plant_step, nullptr, nullptr};
+
+    // clock
+    double   host_t0_us = 0.0;
+    double   lock_us = 0.0;      // lockstep: where the firmware's waits have taken the clock
+    double   t_us = 0.0;         // plant time
+    double   irq_t_us = -1.0;    // >= 0 while an edge is being delivered: the clock reads this
+
+    // drive and plant
+    uint16_t pwm_wrap = 0xFFFF;
+    uint16_t pwm_level = 0;
+    bool     pwm_on = false;
+    bool     dir_ccw = false;    // DIR high = CCW = unwind
+    PlantState s = {0.0f, 0.0f};
+    double   travel = 0.0;       // FG pulses of drum travel, either direction
+    double   line_out = 0.0;     // pulses, + paid out
+
+    // FG interrupt
+    gpio_irq_callback_t cb = nullptr;
+    bool     fg_irq_on = false;
+    uint32_t masked = 0;
+    bool     advancing = false;
+    std::deque<double> pending;  // edge times while masked
+
+    // rangefinder
+    std::deque<uint8_t> uart_rx;
+    double   next_frame_us = 0.0;
+} g_sitl;
+
+uint8_t* sitl_flash = nullptr;
+uart_inst_t* const sitl_uart0 = (uart_inst_t*)1;
+uart_inst_t* const sitl_uart1 = (uart_inst_t*)2;
+i2c_inst_t* const sitl_i2c0 = (i2c_inst_t*)1;
+i2c_inst_t* const sitl_i2c1 = (i2c_inst_t*)2;
+
+// Default world: the variant's plant, the payload backdriving it at slip_mps below the deadzone
+static double sitl_plant_step(void*, float duty, bool dir_ccw, double, double dt_s) {
+    plant_step(g_sitl.s, g_sitl.p, duty, (float)dt_s);
+
+    double v = dir_ccw ? g_sitl.s.speed_pps : -g_sitl.s.speed_pps;
+    if (duty <= g_sitl.p.deadzone_pct && g_sitl.s.speed_pps < 1.0f) {
+        v += g_sitl.slip_mps * g_sitl.w.pulses_per_meter;
+    }
+    return v;
+}
+
+static double host_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec * 1e-3;
+}
+
+static void host_sleep_us(double us) {
+    if (us <= 0.0) return;
+    struct timespec ts;
+    ts.tv_sec = (time_t)(us / 1e6);
+    ts.tv_nsec = (long)((us - (double)ts.tv_sec * 1e6) * 1e3);
+    nanosleep(&ts, nullptr);
+}
+
+static void sitl_deliver(double t_us) {
+    if (!g_sitl.cb || !g_sitl.fg_irq_on) return;
+    g_sitl.irq_t_us = t_us;
+    g_sitl.cb(FG_PIN, GPIO_IRQ_EDGE_RISE);
+    g_sitl.irq_t_us = -1.0;
+}
+
+static void sitl_edge(double t_us) {
+    if (g_sitl.masked) g_sitl.pending.push_back(t_us);
+    else sitl_deliver(t_us);
+}
+
+// Run the world up to the clock, raising FG edges and rangefinder frames on the way
+static void sitl_advance() {
+    if (g_sitl.advancing || g_sitl.irq_t_us >= 0.0) return;
+    g_sitl.advancing = true;
+
+    const SitlWorld& wd = g_sitl.world;
+    double now = (g_sitl.rate > 0.0) ? (host_us() - g_sitl.host_t0_us) * g_sitl.rate : g_sitl.lock_us;
+    while (g_sitl.t_us < now) {
+        double dt_us = now - g_sitl.t_us;
+        if (dt_us > SITL_STEP_US) dt_us = SITL_STEP_US;
+
+        float duty = g_sitl.pwm_on ? 100.0f * (float)g_sitl.pwm_level / (float)g_sitl.pwm_wrap : 0.0f;
+        double v = wd.step(wd.ctx, duty, g_sitl.dir_ccw, g_sitl.t_us * 1e-6, dt_us * 1e-6);
+        if (g_sitl.line_out + v * dt_us * 1e-6 < 0.0) v = -g_sitl.line_out / (dt_us * 1e-6);   // wound in
+
+        double from = g_sitl.travel;
+        double step = fabs(v) * dt_us * 1e-6;
+        g_sitl.travel += step;
+        g_sitl.line_out += v * dt_us * 1e-6;
+
+        // each whole pulse crossed is a rising edge, at its interpolated time
+        for (double e = floor(from) + 1.0; e <= g_sitl.travel; e += 1.0) {
+            double te = g_sitl.t_us + dt_us * (e - from) / step;
+            uint32_t n = wd.edges ? wd.edges(wd.ctx, te * 1e-6) : 1;
+            for (uint32_t k = 0; k < n; k++) sitl_edge(te);
+        }
+        g_sitl.t_us += dt_us;
+
+        uint32_t spurious = wd.noise ? wd.noise(wd.ctx, g_sitl.t_us * 1e-6, dt_us * 1e-6) : 0;
+        for (uint32_t k = 0; k < spurious; k++) sitl_edge(g_sitl.t_us);
+
+        if (g_sitl.height_m > 0.0f && g_sitl.t_us >= g_sitl.next_frame_us) {
+            g_sitl.next_frame_us = g_sitl.t_us + SITL_RANGE_US;
+            float h = g_sitl.height_m - (float)(g_sitl.line_out / g_sitl.w.pulses_per_meter);
+            uint8_t frame[RANGE_FRAME_LEN];
+            range_encode_frame(frame, h > 0.1f ? h : 0.1f, 1000);
+            g_sitl.uart_rx.insert(g_sitl.uart_rx.end(), frame, frame + RANGE_FRAME_LEN);
+            while (g_sitl.uart_rx.size() > 256) g_sitl.uart_rx.pop_front();   // FIFO overrun
+        }
+    }
+    g_sitl.advancing = false;
+}
+
+static uint64_t sitl_now_us() {
+    if (g_sitl.irq_t_us >= 0.0) return (uint64_t)g_sitl.irq_t_us;
+    sitl_advance();
+    return (uint64_t)g_sitl.t_us;
+}
+
+// Lockstep: let us of firmware time pass
+static void sitl_pass_us(double us) {
+    g_sitl.lock_us = fmax(g_sitl.lock_us, g_sitl.t_us) + us;
+    sitl_advance();
+}
+
+// ---- pico/stdlib.h ----
+
+absolute_time_t get_absolute_time() { return sitl_now_us(); }
+uint32_t time_us_32() { return (uint32_t)sitl_now_us(); }
+uint64_t time_us_64() { return sitl_now_us(); }
+bool time_reached(absolute_time_t t) { return sitl_now_us() >= t; }
+
+void sleep_us(uint64_t us) {
+    if (g_sitl.rate <= 0.0) {
+        sitl_pass_us((double)us);
+        return;
+    }
+    uint64_t end = sitl_now_us() + us;
+    while (sitl_now_us() < end) host_sleep_us((double)(end - sitl_now_us()) / g_sitl.rate);
+}
+
+void sleep_ms(uint32_t ms) { sleep_us((uint64_t)ms * 1000); }
+
+void tight_loop_contents() {
+    if (g_sitl.rate <= 0.0) {
+        sitl_pass_us(SITL_SPIN_US);
+        return;
+    }
+    host_sleep_us(SITL_SPIN_US);
+    clearerr(stdout);   // a full pty drops output; keep stdout usable
+}
+
+// Returns true on timeout; an edge delivered while waiting is the event
+bool best_effort_wfe_or_timeout(absolute_time_t timeout) {
+    uint32_t seen = g_fg_total;
+    while (g_fg_total == seen) {
+        uint64_t now = sitl_now_us();
+        if (now >= timeout) return true;
+        if (g_sitl.rate <= 0.0) sitl_pass_us(fmin(SITL_SPIN_US, (double)(timeout - now)));
+        else host_sleep_us(SITL_SPIN_US);
+    }
+    return false;
+}
+
+void __sev() {}
+
+bool stdio_init_all() { return true; }
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    if (g_sitl.in_fd < 0) {
+        if (g_sitl.rate <= 0.0) sitl_pass_us(timeout_us ? (double)timeout_us : SITL_POLL_US);
+        else host_sleep_us((double)timeout_us / g_sitl.rate);
+        return PICO_ERROR_TIMEOUT;
+    }
+
+    struct pollfd pfd = {g_sitl.in_fd, POLLIN, 0};
+    int wait_ms = (int)(timeout_us / 1000 / (g_sitl.rate > 1.0 ? g_sitl.rate : 1.0));
+    if (poll(&pfd, 1, wait_ms) <= 0 || !(pfd.revents & POLLIN)) return PICO_ERROR_TIMEOUT;
+
+    unsigned char c;
+    return (read(g_sitl.in_fd, &c, 1) == 1) ? (int)c : (int)PICO_ERROR_TIMEOUT;
+}
+
+// ---- GPIO ----
+
+void gpio_init(uint) {}
+void gpio_set_dir(uint, bool) {}
+void gpio_pull_up(uint) {}
+void gpio_set_function(uint, enum gpio_function) {}
+
+void gpio_put(uint gpio, bool value) {
+    sitl_advance();
+    if (gpio == DIR_PIN) g_sitl.dir_ccw = value;
+}
+
+// FG reads high over the first half of each pulse
+bool gpio_get(uint gpio) {
+    sitl_advance();
+    return gpio == FG_PIN && g_sitl.travel - floor(g_sitl.travel) < 0.5;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled) {
+    sitl_advance();
+    if (gpio == FG_PIN && (events & GPIO_IRQ_EDGE_RISE)) g_sitl.fg_irq_on = enabled;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t cb) {
+    g_sitl.cb = cb;
+    gpio_set_irq_enabled(gpio, events, enabled);
+}
+
+// ---- hardware/sync.h ----
+
+uint32_t save_and_disable_interrupts() {
+    return g_sitl.masked++;
+}
+
+void restore_interrupts(uint32_t status) {
+    g_sitl.masked = status;
+    if (g_sitl.masked) return;
+    while (!g_sitl.pending.empty()) {
+        double t = g_sitl.pending.front();
+        g_sitl.pending.pop_front();
+        sitl_deliver(t);
+    }
+}
+
+// ---- hardware/pwm.h ----
+
+uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1) & 7u; }
+uint pwm_gpio_to_channel(uint gpio) { return gpio & 1u; }
+
+void pwm_set_wrap(uint, uint16_t wrap) {
+    sitl_advance();
+    g_sitl.pwm_wrap = wrap ? wrap : 1;
+}
+
+void pwm_set_chan_level(uint, uint, uint16_t level) {
+    sitl_advance();
+    g_sitl.pwm_level = level;
+}
+
+void pwm_set_enabled(uint, bool enabled) {
+    sitl_advance();
+    g_sitl.pwm_on = enabled;
+}
+
+// ---- hardware/adc.h ----
+
+void adc_init() {}
+void adc_gpio_init(uint) {}
+void adc_select_input(uint) {}
+uint16_t adc_read() { return 2048; }
+
+// ---- hardware/uart.h ----
+
+uint uart_init(uart_inst_t*, uint baudrate) { return baudrate; }
+
+bool uart_is_readable(uart_inst_t* uart) {
+    sitl_advance();
+    return uart == uart1 && !g_sitl.uart_rx.empty();
+}
+
+char uart_getc(uart_inst_t* uart) {
+    while (!uart_is_readable(uart)) tight_loop_contents();
+    char c = (char)g_sitl.uart_rx.front();
+    g_sitl.uart_rx.pop_front();
+    return c;
+}
+
+// ---- hardware/i2c.h ----
+
+uint i2c_init(i2c_inst_t*, uint baudrate) { return baudrate; }
+int i2c_write_timeout_us(i2c_inst_t*, uint8_t, const uint8_t*, size_t, bool, uint) { return PICO_ERROR_GENERIC; }
+int i2c_read_timeout_us(i2c_inst_t*, uint8_t, uint8_t*, size_t, bool, uint) { return PICO_ERROR_GENERIC; }
+
+// ---- hardware/flash.h ----
+
+void flash_range_erase(uint32_t off, size_t n) {
+    if (off + n <= PICO_FLASH_SIZE_BYTES) memset(sitl_flash + off, 0xFF, n);
+}
+
+void flash_range_program(uint32_t off, const uint8_t* data, size_t n) {
+    if (off + n > PICO_FLASH_SIZE_BYTES) return;
+    for (size_t i = 0; i < n; i++) sitl_flash[off + i] &= data[i];
+}
+
+// ---- tools ----
+
+// Send the firmware's log to /dev/null (or back to stdout), e.g. around a boot
+static inline void sitl_mute(bool mute) {
+    static int saved = -1;
+    fflush(stdout);
+    if (mute && saved < 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd < 0) return;
+        saved = dup(STDOUT_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+    } else if (!mute && saved >= 0) {
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+        saved = -1;
+    }
+}
+
+// Boot the firmware in lockstep on a blank flash, as variant, up to the point main() would start
+// the mission; nothing on the USB link. The variant goes in as the one stored parameter, as after
+// "param set variant <n>" + "param save" on a fresh board.
+static inline void sitl_boot(uint32_t variant) {
+    g_sitl.rate = 0.0;
+    g_sitl.in_fd = -1;
+    g_sitl.w = winch_derive(variant);
+    g_sitl.p = plant_default_params(g_sitl.w.full_speed_pps, g_sitl.w.pulses_per_meter);
+
+    sitl_flash = (uint8_t*)malloc(PICO_FLASH_SIZE_BYTES);
+    if (!sitl_flash) abort();
+    memset(sitl_flash, 0xFF, PICO_FLASH_SIZE_BYTES);
+
+    static ParamRecord rec;
+    ParamSet s;
+    params_defaults(s);
+    s.variant = variant;
+    params_to_record(s, rec);
+    const ParamDef* d = param_find("variant");
+    for (size_t i = 0; i < PARAM_RECORD_MAX; i++) {
+        if (rec.e[i].id != d->id) rec.e[i] = {0, 0, 0};
+    }
+    store_save(STORE_SLOT_PARAMS, STORE_KIND_PARAMS, &rec, sizeof(rec));
+
+    board_init();
+}
+
+// One command-link line, as typed on the USB port with the winch idle
+static inline void sitl_command(const char* line) {
+    char buf[CMD_LINE_MAX];
+    snprintf(buf, sizeof(buf), "%s", line);
+    command_line(buf, true);
+}
+
+// Current time on the firmware's clock, s
+static inline double sitl_time_s() {
+    return (double)sitl_now_us() * 1e-6;
+}
+
+// Run run(i, out[i]) for every i, each in its own forked copy of this process (the firmware as
+// it is now), at most jobs at once, with the firmware's log muted. Out must be trivially
+// copyable; ok[i] is false where the child died before reporting.
+template <typename Out, typename Fn>
+static std::vector<bool> sitl_fork_runs(std::vector<Out>& out, unsigned jobs, Fn run) {
+    struct Child { pid_t pid; int fd; size_t i; };
+    std::vector<bool> ok(out.size(), false);
+    std::deque<Child> live;
+    if (jobs == 0) jobs = 1;
+    fflush(stdout);
+    fflush(stderr);
+
+    auto reap = [&](const Child& c) {
+        size_t got = 0;
+        ssize_t r;
+        char* p = (char*)&out[c.i];
+        while (got < sizeof(Out) && (r = read(c.fd, p + got, sizeof(Out) - got)) > 0) got += (size_t)r;
+        close(c.fd);
+        int status = 0;
+        waitpid(c.pid, &status, 0);
+        ok[c.i] = got == sizeof(Out) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    };
+
+    for (size_t next = 0; next < out.size() || !live.empty();) {
+        if (next < out.size() && live.size() < jobs) {
+            int fds[2];
+            if (pipe(fds) != 0) { perror("pipe"); exit(1); }
+            pid_t pid = fork();
+            if (pid < 0) { perror("fork"); exit(1); }
+            if (pid == 0) {
+                close(fds[0]);
+                sitl_mute(true);
+                Out o = out[next];
+                run(next, o);
+                ssize_t w = write(fds[1], &o, sizeof(o));
+                _exit(w == (ssize_t)sizeof(o) ? 0 : 1);
+            }
+            close(fds[1]);
+            live.push_back({pid, fds[0], next++});
+            continue;
+        }
+        reap(live.front());
+        live.pop_front();
+    }
+    return ok;
+}
@@ -0,0 +1,118 @@
+// Host simulation of active swing damping (Motor-Control/swing_damper.h) on a variable-length
+// pendulum driven by the winch plant model.
+//
+// Build: g++ -O2 -std=c++17 -I../Motor-Control swing_sim.cpp -o swing_sim
+// Usage: swing_sim [line_m] [theta0_deg] [mod_rate_mps] [tension|angle]
+//
+// Runs the same swing with damping off and on and reports how long the swing takes to fall
+// to half its initial amplitude. Exit code 1 unless damping ends with less than half the
+// passive amplitude and stays inside the excursion limit.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "winch_variants.h"
+#include "winch_model.h"
+#include "control_law.h"
+#include "swing_damper.h"
+
+struct SimResult {
+    float t50_s;          // time to 50 % amplitude (or the horizon)
+    float final_amp_deg;
+    float max_excursion_m;
+};
+
+// Amplitude from swing energy per unit mass: 1/2 L^2 thetadot^2 + g L (1 - cos theta)
+static float swing_amplitude(float L, float th, float thd) {
+    float e = 0.5f * L * L * thd * thd + SWING_G * L * (1.0f - cosf(th));
+    float c = 1.0f - e / (SWING_G * L);
+    if (c < -1.0f) c = -1.0f;
+    return acosf(c);
+}
+
+static SimResult simulate(const PlantParams& p, const SwingDamperCfg& cfg, bool damping, bool use_tension,
+                          float L0, float theta0, float horizon_s) {
+    const float dt = 0.0005f;
+    const float ctrl_dt = SPEED_LOOP_DT_S;
+    const float slew_rate = 200.0f;
+    const float air_damping = 0.01f;   // passive decay, 1/s
+
+    float L = L0, th = theta0, thd = 0.0f;
+    PlantState drum = {0.0f, 0.0f};
+    ReversingDrive drive = {true};
+    float duty = 0.0f, duty_target = 0.0f, ctrl_t = 0.0f;
+    float tension_mean = SWING_G, ripple = 0.0f;
+    float amp0 = swing_amplitude(L, th, thd);
+
+    SimResult r = {horizon_s, 0.0f, 0.0f};
+
+    for (float t = 0.0f; t < horizon_s; t += dt) {
+        float Ldot = (drive.paying_out ? 1.0f : -1.0f) * drum.speed_pps / p.pulses_per_meter;
+
+        // tension per unit mass along the line
+        float tension = SWING_G * cosf(th) + L * thd * thd;
+        tension_mean += (tension - tension_mean) * (dt / 2.0f);
+        // mean |relative ripple| * pi/2 ~ ripple amplitude
+        ripple += (fabsf(tension / tension_mean - 1.0f) * 1.5708f - ripple) * (dt / 2.0f);
+
+        if (damping && ctrl_t >= ctrl_dt) {
+            float rate = use_tension
+                ? swing_rate_from_tension(cfg, tension, tension_mean, ripple, L - L0)
+                : swing_rate_from_angle(cfg, th, thd, L, L - L0);
+            duty_target = reversing_drive_step(drive, p, rate, duty);
+            ctrl_t = 0.0f;
+        }
+
+        duty = slew_step(duty, duty_target, slew_rate, dt);
+        plant_step(drum, p, duty, dt);
+
+        // L thdd + 2 Ldot thd + g sin th = 0 (+ light air damping)
+        float thdd = (-SWING_G * sinf(th) - 2.0f * Ldot * thd) / L - air_damping * thd;
+        thd += thdd * dt;
+        th  += thd * dt;
+        L   += Ldot * dt;
+        ctrl_t += dt;
+
+        if (fabsf(L - L0) > r.max_excursion_m) r.max_excursion_m = fabsf(L - L0);
+
+        float amp = swing_amplitude(L, th, thd);
+        if (r.t50_s == horizon_s && amp < 0.5f * amp0) r.t50_s = t;
+        r.final_amp_deg = amp * 180.0f / (float)M_PI;
+    }
+    return r;
+}
+
+int main(int argc, char** argv) {
+    float L0         = (argc > 1) ? strtof(argv[1], nullptr) : 3.0f;
+    float theta0_deg = (argc > 2) ? strtof(argv[2], nullptr) : 10.0f;
+    float mod_rate   = (argc > 3) ? strtof(argv[3], nullptr) : 0.25f;
+    bool use_tension = (argc > 4) && strcmp(argv[4], "tension") == 0;
+
+    WinchDerived w = winch_derive(WINCH_VARIANT);
+    PlantParams p = plant_default_params(w.full_speed_pps, w.pulses_per_meter);
+
+    SwingDamperCfg cfg;
+    cfg.mod_rate_mps    = mod_rate;
+    cfg.min_angle_rad   = 0.01f;
+    cfg.min_ripple      = 0.002f;
+    cfg.max_excursion_m = 0.3f;
+    cfg.pos_kp          = 0.2f;
+
+    const float horizon = 60.0f;
+    float th0 = theta0_deg * (float)M_PI / 180.0f;
+
+    SimResult off = simulate(p, cfg, false, use_tension, L0, th0, horizon);
+    SimResult on  = simulate(p, cfg, true,  use_tension, L0, th0, horizon);
+
+    printf("[SWING_SIM] %s L=%.2f m theta0=%.1f deg mod_rate=%.2f m/s source=%s\n",
+           w.v->name, L0, theta0_deg, mod_rate, use_tension ? "tension" : "angle");
+    printf("[SWING_SIM] passive: t50=%.1f s final=%.2f deg\n", off.t50_s, off.final_amp_deg);
+    printf("[SWING_SIM] damped:  t50=%.1f s final=%.2f deg excursion=%.3f m\n",
+           on.t50_s, on.final_amp_deg, on.max_excursion_m);
+
+    bool ok = on.final_amp_deg < 0.5f * off.final_amp_deg &&
+              on.max_excursion_m <= cfg.max_excursion_m + 0.05f;
+    printf("[SWING_SIM] %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,332 @@
+// Inspect, dump and generate trace files (Motor-Control/trace_file.h).
+//
+// Build: g++ -O2 -std=c++17 -I../Motor-Control trace_tool.cpp -o trace_tool
+// Usage: trace_tool info <file>
+//        trace_tool dump <file> [from_s [to_s]]     records in a time window (s from start)
+//        trace_tool gen <file> [minutes [unit [fw]]] synthetic mission from the plant model
+//        trace_tool import <log> <file> [unit [fw]]  "trace dump" output (trace_codec.h) -> trace file
+//        trace_tool pack <file>                     size and round trip through the device encoding
+//
+// dump seeks through the index, so a window at the end of a multi-GB trace costs the same
+// as one at the start.
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "winch_variants.h"
+#include "winch_model.h"
+#include "control_law.h"
+#include "trace_file.h"
+#include "trace_codec.h"
+#include <vector>
+
+static const char* kind_name(uint8_t k) {
+    switch (k) {
+    case TRACE_EDGE:   return "edge";
+    case TRACE_SAMPLE: return "sample";
+    case TRACE_EVENT:  return "event";
+    default:           return "?";
+    }
+}
+
+static int cmd_info(const char* path) {
+    TraceMap m;
+    if (!trace_map_open(m, path)) {
+        fprintf(stderr, "%s: not a finalised trace\n", path);
+        return 1;
+    }
+    const TraceView& v = m.view;
+
+    uint64_t records = 0;
+    int32_t pmin = 0, pmax = 0;
+    for (uint32_t c = 0; c < v.hdr->chunk_count; c++) {
+        records += v.index[c].count;
+        if (c == 0 || v.index[c].pos_min < pmin) pmin = v.index[c].pos_min;
+        if (c == 0 || v.index[c].pos_max > pmax) pmax = v.index[c].pos_max;
+    }
+
+    uint64_t t0 = v.hdr->chunk_count ? v.index[0].t_first_us : 0;
+    uint64_t t1 = v.hdr->chunk_count ? v.index[v.hdr->chunk_count - 1].t_last_us : 0;
+
+    printf("[TRACE] file=%s bytes=%zu version=%u unit=%u fw=%.16s\n",
+           path, m.size, (unsigned)v.hdr->version, (unsigned)v.hdr->unit_id, v.hdr->fw_version);
+    printf("[TRACE] chunks=%u records=%llu span_s=%.3f pos=[%ld, %ld]\n",
+           (unsigned)v.hdr->chunk_count, (unsigned long long)records, (double)(t1 - t0) * 1e-6,
+           (long)pmin, (long)pmax);
+
+    trace_map_close(m);
+    return 0;
+}
+
+static int cmd_dump(const char* path, double from_s, double to_s) {
+    TraceMap m;
+    if (!trace_map_open(m, path)) {
+        fprintf(stderr, "%s: not a finalised trace\n", path);
+        return 1;
+    }
+
+    uint64_t base = m.view.hdr->t_start_us;
+    uint64_t t_from = base + (uint64_t)(from_s * 1e6);
+    uint64_t t_to = (to_s > 0.0) ? base + (uint64_t)(to_s * 1e6) : UINT64_MAX;
+
+    TraceCursor c;
+    trace_seek(c, m.view, t_from);
+
+    const TraceRecord* r;
+    uint64_t t;
+    while (trace_next(c, &r, &t) && t <= t_to) {
+        printf("%.6f %s pos=%ld duty=%.2f arg=%u\n", (double)(t - base) * 1e-6, kind_name(r->kind),
+               (long)r->pos, (double)r->duty_c * 0.01, (unsigned)r->arg);
+    }
+
+    trace_map_close(m);
+    return 0;
+}
+
+// Repeated unwind / hold / wind cycles through the plant model, recording every FG edge,
+// a sample per speed-loop update and the move/hold events. Distances and speeds vary from
+// cycle to cycle, seeded by the unit id.
+static int cmd_gen(const char* path, double minutes, uint32_t unit, const char* fw) {
+    WinchDerived w = winch_derive(WINCH_VARIANT);
+    PlantParams p = plant_default_params(w.full_speed_pps, w.pulses_per_meter);
+
+    TraceWriter tw;
+    if (!trace_writer_open(tw, path, unit, fw, 0)) {
+        fprintf(stderr, "%s: cannot write\n", path);
+        return 1;
+    }
+
+    const float dt = 0.0005f;
+    PlantState s = {0.0f, 0.0f};
+    float duty = 0.0f, target = 0.0f, ctrl_t = 0.0f;
+    int32_t line_out = 0;
+    uint32_t last_edge = 0;
+    bool ok = true;
+
+    // as the firmware: the stop is commanded at the target, the hold starts after the brake
+    enum { UNWIND, BRAKE, HOLD, WIND, PAUSE } phase = PAUSE;
+    bool winding = false;
+    float phase_t = 0.0f, cruise = 100.0f;
+    uint32_t move_target = 0, move_start = 0;
+    srand(unit);
+
+    for (double t = 0.0; t < minutes * 60.0; t += dt) {
+        uint64_t t_us = (uint64_t)(t * 1e6);
+        phase_t += dt;
+
+        switch (phase) {
+        case PAUSE:
+            if (phase_t > 2.0f) {
+                phase = UNWIND;
+                winding = false;
+                phase_t = 0.0f;
+                move_start = last_edge;
+                move_target = (uint32_t)((0.4f + 0.4f * (float)rand() / RAND_MAX) * w.pulses_per_meter);
+                cruise = 70.0f + 30.0f * (float)rand() / RAND_MAX;
+                target = cruise;
+                ok = ok && trace_write(tw, t_us, TRACE_EVENT, TRACE_EV_MOVE_START, line_out, duty);
+            }
+            break;
+        case UNWIND:
+        case WIND:
+            if (last_edge - move_start >= move_target) {
+                target = 0.0f;
+                ok = ok && trace_write(tw, t_us, TRACE_EVENT, TRACE_EV_MOVE_END, line_out, duty);
+                phase = BRAKE;
+                phase_t = 0.0f;
+            }
+            break;
+        case BRAKE:
+            if (phase_t > 0.3f) {
+                if (!winding) {
+                    phase = HOLD;
+                    ok = ok && trace_write(tw, t_us, TRACE_EVENT, TRACE_EV_HOLD_START, line_out, duty);
+                } else {
+                    phase = PAUSE;
+                }
+                phase_t = 0.0f;
+            }
+            break;
+        case HOLD:
+            if (phase_t > 2.0f) {
+                ok = ok && trace_write(tw, t_us, TRACE_EVENT, TRACE_EV_HOLD_END, line_out, duty);
+                phase = WIND;
+                winding = true;
+                phase_t = 0.0f;
+                move_start = last_edge;
+                target = cruise;
+                ok = ok && trace_write(tw, t_us, TRACE_EVENT, TRACE_EV_MOVE_START, line_out, duty);
+            }
+            break;
+        }
+
+        duty = slew_step(duty, target, target > duty ? 200.0f : 400.0f, dt);
+        plant_step(s, p, duty, dt);
+
+        while ((uint32_t)s.pos_pulses > last_edge) {
+            last_edge++;
+            line_out += winding ? -1 : 1;
+            ok = ok && trace_write(tw, t_us, TRACE_EDGE, 1, line_out, duty);
+        }
+
+        ctrl_t += dt;
+        if (ctrl_t >= SPEED_LOOP_DT_S) {
+            ctrl_t = 0.0f;
+            float signed_duty = winding ? -duty : duty;
+            ok = ok && trace_write(tw, t_us, TRACE_SAMPLE, 0, line_out, signed_duty);
+        }
+    }
+
+    ok = trace_writer_close(tw) && ok;
+    if (!ok) {
+        fprintf(stderr, "%s: write failed\n", path);
+        return 1;
+    }
+    return cmd_info(path);
+}
+
+// Hex lines of a "trace dump" capture ("[TRACE] hex <offset> <bytes>"), decoded into a trace file
+static int cmd_import(const char* log_path, const char* path, uint32_t unit, const char* fw) {
+    FILE* f = fopen(log_path, "r");
+    if (!f) {
+        fprintf(stderr, "%s: cannot read\n", log_path);
+        return 1;
+    }
+
+    std::vector<uint8_t> bytes;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        const char* p = strstr(line, "[TRACE] hex ");
+        if (!p) continue;
+
+        char* hex;
+        unsigned long off = strtoul(p + 12, &hex, 16);
+        if (off != bytes.size()) {
+            fprintf(stderr, "%s: gap at offset %lx, stopping there\n", log_path, off);
+            break;
+        }
+        while (*hex == ' ') hex++;
+        for (; isxdigit((unsigned char)hex[0]) && isxdigit((unsigned char)hex[1]); hex += 2) {
+            char b[3] = {hex[0], hex[1], 0};
+            bytes.push_back((uint8_t)strtoul(b, nullptr, 16));
+        }
+    }
+    fclose(f);
+
+    TraceDecoder d;
+    trace_dec_init(d, bytes.data(), bytes.size());
+
+    TraceWriter tw;
+    bool ok = false;
+    TraceRecord r;
+    uint64_t t;
+    if (trace_dec_next(d, &r, &t) && trace_writer_open(tw, path, unit, fw, t)) {
+        ok = true;
+        do {
+            ok = trace_write(tw, t, (TraceKind)r.kind, r.arg, r.pos, (float)r.duty_c * 0.01f) && ok;
+        } while (trace_dec_next(d, &r, &t));
+        ok = trace_writer_close(tw) && ok;
+    }
+
+    if (d.error) {
+        fprintf(stderr, "%s: corrupt at byte %ld of %zu, kept what came before\n", log_path,
+                (long)(d.p - bytes.data()), bytes.size());
+    }
+    if (!ok) {
+        fprintf(stderr, "%s: nothing decoded or write failed\n", path);
+        return 1;
+    }
+    return cmd_info(path);
+}
+
+// Encodes a trace file as the device would and decodes it back: size, and that time, kind,
+// position and sample duty survive
+static int cmd_pack(const char* path) {
+    TraceMap m;
+    if (!trace_map_open(m, path)) {
+        fprintf(stderr, "%s: not a finalised trace\n", path);
+        return 1;
+    }
+
+    std::vector<uint8_t> buf(64u << 20);
+    TraceEncoder e;
+    trace_enc_init(e, buf.data(), (uint32_t)buf.size());
+
+    TraceCursor c;
+    trace_rewind(c, m.view);
+    const TraceRecord* r;
+    uint64_t t, n = 0;
+    int32_t pos = 0;
+    while (trace_next(c, &r, &t)) {
+        uint32_t t32 = (uint32_t)t;
+        if (n == 0) {
+            trace_enc_start(e, t32, r->pos, r->kind == TRACE_SAMPLE ? r->duty_c : 0);
+            pos = r->pos;
+        }
+        if (r->kind == TRACE_EDGE) {
+            trace_enc_edge(e, t32, r->pos >= pos);
+        } else if (r->kind == TRACE_SAMPLE) {
+            trace_enc_sample(e, t32, r->pos, r->duty_c);
+        } else {
+            trace_enc_event(e, t32, (TraceEvent)r->arg, r->pos);
+        }
+        pos = r->pos;
+        n++;
+    }
+    if (e.full) {
+        fprintf(stderr, "%s: too long for the pack buffer\n", path);
+        trace_map_close(m);
+        return 1;
+    }
+
+    TraceDecoder d;
+    trace_dec_init(d, buf.data(), e.len);
+    trace_rewind(c, m.view);
+
+    uint64_t mismatches = 0, decoded = 0, td;
+    TraceRecord o;
+    while (trace_next(c, &r, &t)) {
+        if (!trace_dec_next(d, &o, &td)) break;
+        decoded++;
+
+        bool same = (uint32_t)td == (uint32_t)t && o.kind == r->kind && o.pos == r->pos &&
+                    (r->kind != TRACE_SAMPLE || o.duty_c == r->duty_c) &&
+                    (r->kind != TRACE_EVENT || o.arg == r->arg);
+        if (!same && mismatches++ < 5) {
+            printf("[PACK] mismatch at record %llu: t=%llu/%llu kind=%u/%u pos=%ld/%ld\n",
+                   (unsigned long long)decoded, (unsigned long long)t, (unsigned long long)td,
+                   (unsigned)r->kind, (unsigned)o.kind, (long)r->pos, (long)o.pos);
+        }
+    }
+
+    printf("[PACK] records=%llu raw=%llu packed=%lu ratio=%.1f bytes/record=%.2f decoded=%llu mismatches=%llu%s\n",
+           (unsigned long long)n, (unsigned long long)(n * sizeof(TraceRecord)), (unsigned long)e.len,
+           e.len ? (double)(n * sizeof(TraceRecord)) / e.len : 0.0, n ? (double)e.len / (double)n : 0.0,
+           (unsigned long long)decoded, (unsigned long long)mismatches, d.error ? " (decode error)" : "");
+
+    trace_map_close(m);
+    return (mismatches == 0 && decoded == n && !d.error) ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && strcmp(argv[1], "info") == 0) return cmd_info(argv[2]);
+    if (argc >= 3 && strcmp(argv[1], "dump") == 0) {
+        double from = (argc > 3) ? atof(argv[3]) : 0.0;
+        double to   = (argc > 4) ? atof(argv[4]) : 0.0;
+        return cmd_dump(argv[2], from, to);
+    }
+    if (argc >= 4 && strcmp(argv[1], "import") == 0) {
+        uint32_t unit = (argc > 4) ? (uint32_t)strtoul(argv[4], nullptr, 10) : 0;
+        return cmd_import(argv[2], argv[3], unit, (argc > 5) ? argv[5] : "device");
+    }
+    if (argc >= 3 && strcmp(argv[1], "pack") == 0) return cmd_pack(argv[2]);
+    if (argc >= 3 && strcmp(argv[1], "gen") == 0) {
+        uint32_t unit = (argc > 4) ? (uint32_t)strtoul(argv[4], nullptr, 10) : 1;
+        return cmd_gen(argv[2], (argc > 3) ? atof(argv[3]) : 1.0, unit, (argc > 5) ? argv[5] : "sim");
+    }
+
+    fprintf(stderr, "usage: trace_tool info|dump|gen|import|pack <file> ...\n");
+    return 2;
+}
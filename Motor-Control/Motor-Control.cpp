@@ -1,31 +1,160 @@
 #include "pico/stdlib.h"
 #include "hardware/pwm.h"
 #include "hardware/gpio.h"
+#include "hardware/adc.h"
+#include "hardware/uart.h"
+#include "hardware/i2c.h"
+#include "hardware/sync.h"
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
-
+#include <string.h>
+#include "winch_variants.h"
+#include "winch_model.h"
+#include "control_law.h"
+#include "autotune.h"
+#include "settings_store.h"
+#include "params.h"
+#include "command_link.h"
+#include "maint_counters.h"
+#include "line_wear.h"
+#include "input_shaper.h"
+#include "swing_damper.h"
+#include "hold_control.h"
+#include "rangefinder.h"
+#include "energy_profile.h"
+#include "gain_schedule.h"
+#include "trace_codec.h"
 
 // ----------------- USER CONFIG -----------------
 #define PWM_PIN   15
 #define DIR_PIN   14
 #define FG_PIN    16
+#define TENSION_ADC_PIN 26    // optional load-cell amplifier output (ADC0), for swing damping
+#define RANGE_PIN_A 4         // rangefinder: UART1 TX / I2C0 SDA (see range_source)
+#define RANGE_PIN_B 5         //              UART1 RX / I2C0 SCL
 #define PWM_WRAP  6249        // 20 kHz at 125 MHz (for RP2040 default clk)
 
-static constexpr float    GEAR_RATIO              = 14.0f; // 24V 570RPM version (14:1)
-static constexpr uint32_t FG_PULSES_PER_MOTOR_REV = 6;     // datasheet: FG = 6 pulses / motor rev
-static constexpr float    DRUM_DIAMETER_M         = 0.050f; // 50mm drum diameter
+// Motor / gearbox / drum: WINCH_VARIANT at build time (see winch_variants.h),
+// or "param set variant <n>" + "param save" and reboot.
+
+#define AUTOTUNE_IF_MISSING 0   // 1 = identify + autotune on boot when flash holds no tune
 // ------------------------------------------------
 
 // Unsigned pulse count (FG has no direction info)
 static volatile uint32_t g_fg_pulses = 0;
+// Same edges, never reset: feeds the maintenance counters
+static volatile uint32_t g_fg_total = 0;
+// Timestamps of the last three edges (us), for edge-interval speed and its trend
+static volatile uint32_t g_fg_last_us = 0;
+static volatile uint32_t g_fg_prev_us = 0;
+static volatile uint32_t g_fg_prev2_us = 0;
+
+// On-device trace (trace_codec.h): edges are encoded in the FG IRQ, samples and events from
+// the loop with the IRQ masked, so both sides share one encoder. 64 KB holds a mission of
+// several minutes at full speed.
+static constexpr uint32_t TRACE_RAM_BYTES = 64 * 1024;
+static uint8_t g_trace_buf[TRACE_RAM_BYTES];
+static TraceEncoder g_trace = {};
+static volatile bool g_trace_on = false;
+
+static bool fg_paying_out();
 
 static void fg_irq_handler(uint gpio, uint32_t events) {
     if (gpio == FG_PIN && (events & GPIO_IRQ_EDGE_RISE)) {
         g_fg_pulses++;
+        g_fg_total++;
+        g_fg_prev2_us = g_fg_prev_us;
+        g_fg_prev_us = g_fg_last_us;
+        g_fg_last_us = time_us_32();
+        if (g_trace_on) trace_enc_edge(g_trace, g_fg_last_us, fg_paying_out());
+        __sev();   // wake an event-driven wait (hold)
     }
 }
 
+// Drum speed from the last edge interval; decays once edges stop arriving
+static float fg_edge_rate_pps() {
+    uint32_t last = g_fg_last_us, prev = g_fg_prev_us;
+    uint32_t interval = last - prev;
+    uint32_t since = time_us_32() - last;
+
+    if (interval == 0 || prev == 0) return 0.0f;
+    if (since > interval) interval = since;
+    return 1e6f / (float)interval;
+}
+
+// Relative change of the last two edge intervals: > 0 speeding up, < 0 slowing down
+static float fg_edge_trend() {
+    uint32_t last = g_fg_last_us, prev = g_fg_prev_us, prev2 = g_fg_prev2_us;
+    if (prev2 == 0) return 0.0f;
+
+    float older = (float)(prev - prev2);
+    float newer = (float)(last - prev);
+    if (older <= 0.0f) return 0.0f;
+    return (older - newer) / older;
+}
+
+// Selected variant and its derived constants (pulses/m etc.), fixed at boot by winch_select()
+static WinchDerived g_winch = winch_derive(WINCH_VARIANT);
+
+// Plant model + last autotune outcome. Datasheet model until identified.
+// The tuned gains/limits themselves are applied through the parameter registry.
+static PlantParams g_plant = plant_default_params(g_winch.full_speed_pps, g_winch.pulses_per_meter);
+static TuneResult  g_tune  = {};
+
+static constexpr uint16_t STORE_KIND_TUNE   = 0x0101;
+static constexpr uint16_t STORE_KIND_PARAMS = 0x0201;
+static constexpr uint16_t STORE_KIND_MAINT  = 0x0302;
+static constexpr uint16_t STORE_KIND_WEAR   = 0x0401;
+
+// Live parameters. Read through params() every time; never keep the reference across a
+// control tick, the buffer behind it is reused by the next commit.
+static ParamBank g_param_bank;
+
+static const ParamSet& params() {
+    return g_param_bank.sets[g_param_bank.active];
+}
+
+// Lifetime counters + line wear map: accounted every MAINT_BATCH_US, flushed to flash when idle
+static constexpr int64_t  MAINT_BATCH_US          = 50000;
+static constexpr uint32_t MAINT_FLUSH_INTERVAL_MS = 10 * 60 * 1000;
+
+static struct {
+    MaintCounters c;
+    LineWearMap wear;
+    uint32_t last_total = 0;
+    absolute_time_t last_t = {0};
+    absolute_time_t last_flush = {0};
+    bool dirty = false;
+    int last_dir = -1;   // -1 = no motion yet
+    bool dir_cw = false;
+} g_maint;
+
+// Gains/limits across payload, line out and speed, rebuilt whenever the plant model changes
+static GainSchedule g_gs = {};
+
+static void gain_schedule_configure(const TuneSpec& spec = tune_default_spec()) {
+    gs_build(g_gs, g_plant, motor_elec_from(g_winch, g_plant), spec, g_winch.v->max_line_m);
+}
+
+// Gravity feedforward for the current payload, signed by direction (wind = CW lifts)
+static float gravity_ff_pct(bool cw) {
+    if (!params().gravity_ff || !params().line_loaded) return 0.0f;
+    return gravity_duty_pct(motor_elec_from(g_winch, g_plant), params().payload_kg, cw);
+}
+
+// Scheduled point for the current payload and line out at the given duty
+static GainPoint gain_schedule_now(float duty_pct) {
+    float mass = params().line_loaded ? params().payload_kg : 0.0f;
+    float line_m = (float)g_maint.c.line_out_pulses / g_winch.pulses_per_meter;
+    return gs_lookup(g_gs, mass, line_m, duty_pct);
+}
+
+struct TuneRecord {
+    PlantParams plant;
+    TuneResult  tune;
+};
+
 // --- PWM init (20 kHz) ---
 static void pwm_init_motor() {
     gpio_set_function(PWM_PIN, GPIO_FUNC_PWM);
@@ -35,10 +164,10 @@ static void pwm_init_motor() {
     pwm_set_enabled(slice, true);
 }
 
-// percent: 0..100
+// percent: 0..100, capped by the variant's current limit
 static void set_speed(float percent) {
     if (percent < 0) percent = 0;
-    if (percent > 100) percent = 100;
+    if (percent > g_winch.v->max_duty_pct) percent = g_winch.v->max_duty_pct;
     uint level = (uint)(percent / 100.0f * PWM_WRAP);
     pwm_set_chan_level(pwm_gpio_to_slice_num(PWM_PIN),
                        pwm_gpio_to_channel(PWM_PIN),
@@ -55,22 +184,90 @@ static struct {
     bool initialized = false;
 } g_slew;
 
+// Input shapers, sampled every SHAPER_DT_S. While a speed loop is closed the shaper is on its
+// speed reference (ref), ahead of the loop, and the duty goes to the PWM as the loop asks;
+// otherwise (open-loop moves, nudges, stops) it sits between the slew limiter and the PWM (s).
+static struct {
+    InputShaper s;
+    float out = 0.0f;
+    int64_t acc_us = 0;
+    InputShaper ref;
+    float ref_out = 0.0f;
+    int64_t ref_acc_us = 0;
+    bool on_ref = false;
+} g_shaper;
+
+static void shaper_configure() {
+    if (!shaper_design(g_shaper.s, params().shaper_mode, params().shaper_freq_hz, params().shaper_zeta)) {
+        printf("[SHAPER] %.2f Hz is too slow for the shaper buffer, shaping off\n",
+               params().shaper_freq_hz);
+    }
+    shaper_design(g_shaper.ref, params().shaper_mode, params().shaper_freq_hz, params().shaper_zeta);
+}
+
+// A speed loop takes over: shape its reference (pulses/s) from ref0 instead of the duty
+static void ref_shaper_begin(float ref0_pps) {
+    shaper_reset(g_shaper.ref, ref0_pps);
+    g_shaper.ref_out = ref0_pps;
+    g_shaper.ref_acc_us = 0;
+    g_shaper.on_ref = true;
+}
+
+// The speed loop's reference, dt_us after the last one, shaped (held between its updates)
+static float ref_shaper_step(float ref_pps, int64_t dt_us) {
+    if (g_shaper.ref.n == 0) return ref_pps;
+
+    const int64_t shaper_dt_us = (int64_t)(SHAPER_DT_S * 1e6f);
+    g_shaper.ref_acc_us += dt_us;
+    if (g_shaper.ref_acc_us > (int64_t)SHAPER_HIST * shaper_dt_us) {
+        g_shaper.ref_acc_us = (int64_t)SHAPER_HIST * shaper_dt_us;
+    }
+    while (g_shaper.ref_acc_us >= shaper_dt_us) {
+        g_shaper.ref_out = shaper_step(g_shaper.ref, ref_pps);
+        g_shaper.ref_acc_us -= shaper_dt_us;
+    }
+    return g_shaper.ref_out;
+}
+
+// Back to shaping the duty, from where the loop left it so the PWM doesn't jump
+static void ref_shaper_end() {
+    g_shaper.on_ref = false;
+    shaper_reset(g_shaper.s, g_slew.current);
+    g_shaper.out = g_slew.current;
+    g_shaper.acc_us = 0;
+}
+
+// Commit staging and make it live right away; only between control loop iterations
+static void params_commit_now() {
+    param_bank_commit(g_param_bank);
+    param_bank_tick(g_param_bank);
+    shaper_configure();
+}
+
+// Make live = params() plus a calibration result live without publishing the edits waiting
+// in staging; the caller writes the same result into staging itself
+static void params_commit_result(const ParamSet& live) {
+    ParamSet staged = g_param_bank.staging;
+    g_param_bank.staging = live;
+    params_commit_now();
+    g_param_bank.staging = staged;
+}
+
 static void slew_init(float start_percent = 0.0f) {
     g_slew.current = start_percent;
     g_slew.target  = start_percent;
     g_slew.last_t  = get_absolute_time();
     g_slew.initialized = true;
+    shaper_reset(g_shaper.s, start_percent);
+    g_shaper.out = start_percent;
     set_speed(start_percent);
 }
 
 static void slew_set_target(float target_percent, float rate_percent_per_sec = 200.0f) {
     if (!g_slew.initialized) slew_init(0.0f);
 
-    if (target_percent < 0) target_percent = 0;
-    if (target_percent > 100) target_percent = 100;
-
-    g_slew.target = target_percent;
-    g_slew.rate   = (rate_percent_per_sec <= 0) ? 1.0f : rate_percent_per_sec;
+    g_slew.target = slew_clamp_target(target_percent);
+    g_slew.rate   = slew_clamp_rate(rate_percent_per_sec);
 }
 
 static void slew_update() {
@@ -80,20 +277,123 @@ static void slew_update() {
     int64_t dt_us = absolute_time_diff_us(g_slew.last_t, now_t);
     if (dt_us <= 0) return;
 
+    // A step below float resolution (slow rate, tight loop) would be lost; let dt accumulate instead
+    float next = slew_step(g_slew.current, g_slew.target, g_slew.rate, (float)dt_us / 1e6f);
+    if (next == g_slew.current && next != g_slew.target) return;
+
     g_slew.last_t = now_t;
+    g_slew.current = next;
 
-    float dt_s = (float)dt_us / 1e6f;
-    float max_step = g_slew.rate * dt_s;
+    // A closed speed loop shapes its reference instead (ref_shaper_step)
+    if (g_shaper.on_ref) {
+        set_speed(g_slew.current);
+        return;
+    }
 
-    float error = g_slew.target - g_slew.current;
+    // Feed the shaper at its fixed rate (a long gap just repeats the held value)
+    const int64_t shaper_dt_us = (int64_t)(SHAPER_DT_S * 1e6f);
+    g_shaper.acc_us += dt_us;
+    if (g_shaper.acc_us > (int64_t)SHAPER_HIST * shaper_dt_us) {
+        g_shaper.acc_us = (int64_t)SHAPER_HIST * shaper_dt_us;
+    }
+    while (g_shaper.acc_us >= shaper_dt_us) {
+        g_shaper.out = shaper_step(g_shaper.s, g_slew.current);
+        g_shaper.acc_us -= shaper_dt_us;
+    }
 
-    if (fabsf(error) <= max_step) {
-        g_slew.current = g_slew.target;
-    } else {
-        g_slew.current += (error > 0 ? max_step : -max_step);
+    set_speed(g_shaper.s.n > 0 ? g_shaper.out : g_slew.current);
+}
+
+// Fold the FG edges since the last batch into the counters.
+// Pulses with zero duty are gravity backdrive (payout); otherwise the DIR pin decides.
+static void maint_tick() {
+    absolute_time_t now_t = get_absolute_time();
+    int64_t dt_us = absolute_time_diff_us(g_maint.last_t, now_t);
+    if (dt_us < MAINT_BATCH_US) return;
+
+    uint32_t total  = g_fg_total;
+    uint32_t pulses = total - g_maint.last_total;
+    bool driven = g_slew.current > 0.0f;
+    bool paying_out = driven ? !g_maint.dir_cw : true; // unwind = CCW, see unwind_payload_m
+
+    int32_t line_from = g_maint.c.line_out_pulses;
+    maint_account(g_maint.c, pulses, paying_out, g_slew.current, (uint32_t)dt_us,
+                  g_winch.pulses_per_meter);
+
+    // Wear only counts under load; gravity backdrive always is
+    if (params().line_loaded || !driven) {
+        int32_t seg = wear_account(g_maint.wear, line_from, g_maint.c.line_out_pulses,
+                                   g_winch.pulses_per_meter, params().wear_alert_passes);
+        if (seg >= 0) wear_print_alert(g_maint.wear, seg);
     }
 
-    set_speed(g_slew.current);
+    if (pulses > 0 || driven) g_maint.dirty = true;
+    g_maint.last_total = total;
+    g_maint.last_t = now_t;
+}
+
+static void maint_save() {
+    store_save(STORE_SLOT_MAINT, STORE_KIND_MAINT, &g_maint.c, sizeof(g_maint.c));
+    store_save(STORE_SLOT_WEAR, STORE_KIND_WEAR, &g_maint.wear, sizeof(g_maint.wear));
+    g_maint.dirty = false;
+    g_maint.last_flush = get_absolute_time();
+}
+
+// Direction of the edges now: with zero duty it's gravity backdrive (payout), else the DIR pin
+static bool fg_paying_out() {
+    return (g_slew.current > 0.0f) ? !g_maint.dir_cw : true; // unwind = CCW, see unwind_payload_m
+}
+
+// Line out including the edges since the last maint batch
+static int32_t line_out_now() {
+    int32_t pending = (int32_t)(g_fg_total - g_maint.last_total);
+    return g_maint.c.line_out_pulses + (fg_paying_out() ? pending : -pending);
+}
+
+// Applied duty for the trace: negative while winding in
+static int16_t trace_duty_now() {
+    return trace_duty_c(fg_paying_out() ? g_slew.current : -g_slew.current);
+}
+
+static void trace_start() {
+    uint32_t irq = save_and_disable_interrupts();
+    trace_enc_init(g_trace, g_trace_buf, TRACE_RAM_BYTES);
+    trace_enc_start(g_trace, time_us_32(), line_out_now(), trace_duty_now());
+    g_trace_on = true;
+    restore_interrupts(irq);
+}
+
+static void trace_event(TraceEvent ev) {
+    if (!g_trace_on) return;
+    uint32_t irq = save_and_disable_interrupts();
+    trace_enc_event(g_trace, time_us_32(), ev, line_out_now());
+    restore_interrupts(irq);
+}
+
+// One sample per speed-loop period while tracing
+static void trace_tick() {
+    static uint32_t last_us = 0;
+    if (!g_trace_on || g_trace.full) return;
+
+    uint32_t now = time_us_32();
+    if (now - last_us < (uint32_t)(SPEED_LOOP_DT_S * 1e6f)) return;
+    last_us = now;
+
+    uint32_t irq = save_and_disable_interrupts();
+    trace_enc_sample(g_trace, time_us_32(), line_out_now(), trace_duty_now());
+    restore_interrupts(irq);
+}
+
+static void command_poll(bool idle);
+
+// One control tick: pick up a committed parameter set, service the command link, update PWM.
+// idle = no motion in progress, so deferred commands (flash writes, autotune) may run.
+static void control_tick(bool idle = false) {
+    if (param_bank_tick(g_param_bank)) shaper_configure();
+    command_poll(idle);
+    slew_update();
+    maint_tick();
+    trace_tick();
 }
 
 static bool slew_at_target(float eps = 0.5f) {
@@ -101,13 +401,19 @@ static bool slew_at_target(float eps = 0.5f) {
 }
 
 static void brake_to_stop(int settle_ms = 300) {
+    // a stop is open loop: shape the duty again
+    if (g_shaper.on_ref) ref_shaper_end();
+
     // command a stop (non-blocking)
-    slew_set_target(0.0f, 400.0f);
+    slew_set_target(0.0f, params().brake_rate);
+
+    // a shaped stop finishes later by the shaper's duration
+    settle_ms += (int)(shaper_duration_s(g_shaper.s) * 1000.0f);
 
     // wait a short settle time while still updating PWM smoothly
     absolute_time_t t0 = get_absolute_time();
     while (absolute_time_diff_us(t0, get_absolute_time()) < (int64_t)settle_ms * 1000) {
-        slew_update();
+        control_tick();
         tight_loop_contents();
     }
 }
@@ -115,21 +421,18 @@ static void brake_to_stop(int settle_ms = 300) {
 static void set_direction_cw(bool cw) {
     // Wiring convention: LOW=CW, HIGH=CCW
     gpio_put(DIR_PIN, cw ? 0 : 1);
-}
 
-static float drum_circumference_m() {
-    return (float)M_PI * DRUM_DIAMETER_M; // πD
+    if (g_maint.last_dir >= 0 && (int)cw != g_maint.last_dir) g_maint.c.reversals++;
+    g_maint.last_dir = cw;
+    g_maint.dir_cw = cw;
 }
 
-static uint32_t target_pulses_for_meters(float meters) {
-    if (meters <= 0) return 0;
+static bool target_pulses_for_meters(float meters, uint32_t* pulses) {
+    // e.g. 14:1, 6 FG/rev, 50 mm drum: 84 pulses per 0.1571 m ≈ 535 pulses/m
+    if (pulses_for_meters(meters, g_winch.pulses_per_meter, g_winch.v->max_line_m, pulses)) return true;
 
-    // pulses per drum rev = gear_ratio * pulses_per_motor_rev = 14 * 6 = 84
-    const float pulses_per_output_rev = GEAR_RATIO * (float)FG_PULSES_PER_MOTOR_REV;
-    const float meters_per_output_rev = drum_circumference_m(); // ≈ 0.1571 m
-    const float pulses_per_meter      = pulses_per_output_rev / meters_per_output_rev; // ≈ 535
-
-    return (uint32_t)(meters * pulses_per_meter + 0.5f);
+    printf("[MOVE] %.3f m is outside 0..%.1f m\n", (double)meters, (double)g_winch.v->max_line_m);
+    return false;
 }
 
 // Move by distance (meters) using FG pulse counting with stall/timeout + end slowdown
@@ -137,37 +440,53 @@ bool move_meters (
     bool cw, float meters,
     float cruise_percent,
     uint32_t timeout_ms,
-    float padding_m = 0.2f,
-    float padding_speed = 50.0f, // padding in meter
-    int64_t stall_window_us = 500000)   // 500k us = 500 ms
+    float padding_m = params().padding_m,          // padding in meter
+    float padding_speed = params().padding_speed,
+    int64_t stall_window_us = params().stall_window_us)   // default 500 ms
 {
-    uint32_t target = target_pulses_for_meters(meters);
+    uint32_t target, pad_pulses;
+    if (!target_pulses_for_meters(meters, &target)) return false;
     if (target == 0) return true;
 
-    uint32_t pad_pulses = target_pulses_for_meters(padding_m);
-
     // If move is too short for padding, just go slow entire way
-    if (pad_pulses * 2 >= target) {
-        pad_pulses = target / 2;
-    }
+    if (!target_pulses_for_meters(fminf(padding_m, meters), &pad_pulses)) return false;
+    pad_pulses = move_pad_pulses(target, pad_pulses);
 
     gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, false);
     g_fg_pulses = 0;
     gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, true);
 
     set_direction_cw(cw);
+    g_maint.c.moves++;
+    trace_event(TRACE_EV_MOVE_START);
 
     float last_speed = -1.0f;
     float start_speed = (pad_pulses > 0) ? padding_speed : cruise_percent;
-    slew_set_target(start_speed, 200.0f);
+
+    // Tuned moves run closed loop on speed (pulses/s) instead of fixed duty bands
+    float cruise_pps = speed_for_duty(g_plant, cruise_percent);
+    float pad_pps    = speed_for_duty(g_plant, padding_speed);
+    SpeedLoop speed_loop = {0.0f, 0.0f, 0.0f};
+
+    if (params().closed_loop) {
+        // start with the load already balanced instead of waiting for the integrator
+        start_speed = duty_for_speed(g_plant, (pad_pulses > 0) ? pad_pps : cruise_pps) + gravity_ff_pct(cw);
+        if (start_speed < 0.0f) start_speed = 0.0f;
+    }
+
+    slew_set_target(start_speed, params().slew_rate);
     last_speed = start_speed;
+    if (params().closed_loop) ref_shaper_begin(0.0f);
     
     absolute_time_t t0 = get_absolute_time();
     absolute_time_t stall_ref_time = get_absolute_time();
     uint32_t stall_ref_pulses = g_fg_pulses;
+    float stall_ref_duty = g_slew.current;
+    absolute_time_t speed_ref_time = t0;
+    uint32_t speed_ref_pulses = g_fg_pulses;
 
     while (g_fg_pulses < target) {
-        slew_update();
+        control_tick();
         uint32_t now = g_fg_pulses;
 
         // ---- Stall detection ----
@@ -175,57 +494,225 @@ bool move_meters (
             uint32_t dp = g_fg_pulses - stall_ref_pulses;
             float cmd = g_slew.target;
 
-            uint32_t min_pulses;
-            if (cmd < 15.0f)      min_pulses = 0;
-            else if (cmd < 40.0f) min_pulses = 1;
-            else if (cmd < 70.0f) min_pulses = 2;
-            else                  min_pulses = 3;
+            uint32_t min_pulses = stall_min_pulses(cmd);
+
+            // scheduled: what the model expects at this duty under this load
+            if (params().gain_sched) {
+                min_pulses = gs_stall_min_pulses(gain_schedule_now(cmd), g_plant, cmd, cw,
+                                                 (float)stall_window_us * 1e-6f);
+            } else {
+                // the model at the lowest duty the window ran at (the drum lags a rising one),
+                // less what holds the payload; the bands alone pass a jammed drum's noise edges
+                float duty = fminf(stall_ref_duty, g_slew.current) - gravity_ff_pct(cw);
+                uint32_t model_min = stall_min_pulses_model(g_plant, duty, (float)stall_window_us * 1e-6f);
+                if (model_min > min_pulses) min_pulses = model_min;
+            }
 
             if (min_pulses > 0 && dp < min_pulses) {
+                g_maint.c.stalls++;
+                trace_event(TRACE_EV_STALL);
                 brake_to_stop();
                 return false;
             }
 
             stall_ref_pulses = g_fg_pulses;
+            stall_ref_duty = g_slew.current;
             stall_ref_time = get_absolute_time();
         }
 
         // ---- Timeout ----
         if (absolute_time_diff_us(t0, get_absolute_time()) > (int64_t)timeout_ms * 1000) {
+            g_maint.c.timeouts++;
+            trace_event(TRACE_EV_TIMEOUT);
             brake_to_stop();
             return false;
         }
 
-        uint32_t remaining = (now < target) ? (target - now) : 0;
-
         // ---- Speed Selection ----
-        float desired_speed;
-
-        if (now < pad_pulses) desired_speed = padding_speed;
-        else if (remaining < pad_pulses) desired_speed = padding_speed;
-        else desired_speed = cruise_percent;
+        if (params().closed_loop) {
+            // Closed loop: reference in pulses/s, PI trims the model feedforward
+            int64_t dt_us = absolute_time_diff_us(speed_ref_time, get_absolute_time());
+            if (dt_us >= (int64_t)(SPEED_LOOP_DT_S * 1e6f)) {
+                float dt_s = (float)dt_us / 1e6f;
+                float meas = (float)(now - speed_ref_pulses) / dt_s;
+                float ref  = ref_shaper_step(move_speed_ref_pps(now, target, pad_pulses, cruise_pps, pad_pps,
+                                                                params().pos_kp), dt_us);
+
+                // gains are re-read every update so live tuning takes effect mid-move
+                float slew = params().slew_rate;
+                speed_loop.kp = params().speed_kp;
+                speed_loop.ki = params().speed_ki;
+                if (params().gain_sched) {
+                    GainPoint gp = gain_schedule_now(duty_for_speed(g_plant, ref));
+                    speed_loop.kp = gp.speed_kp;
+                    speed_loop.ki = gp.speed_ki;
+                    slew = gp.slew_rate;
+                }
+                slew_set_target(speed_loop_update(speed_loop, g_plant, ref, meas, dt_s, gravity_ff_pct(cw)), slew);
 
-        if (fabsf(desired_speed - last_speed) > 0.01f) {
-            slew_set_target(desired_speed, 200.0f);  // rate = 200 %/s (tune)
-            last_speed = desired_speed;
+                speed_ref_pulses = now;
+                speed_ref_time = get_absolute_time();
+            }
+        } else {
+            float desired_speed = move_duty_open_loop(now, target, pad_pulses, cruise_percent, padding_speed);
+
+            if (fabsf(desired_speed - last_speed) > 0.01f) {
+                float slew = params().gain_sched ? gain_schedule_now(desired_speed).slew_rate
+                                                 : params().slew_rate;
+                slew_set_target(desired_speed, slew);  // default 200 %/s
+                last_speed = desired_speed;
+            }
         }
 
         tight_loop_contents();
     }
 
+    trace_event(TRACE_EV_MOVE_END);
     brake_to_stop();
     return true;
 }
 
-// HOLD: watches FG pulses; if slip occurs, it "nudges" upward a little then stops again.
-// NOTE: FG has no direction, so treat ANY pulses during hold as "movement happened".
+// How long an idle hold sleeps at most before servicing the command link / counters
+static constexpr uint32_t HOLD_TICK_MS = 50;
+
+// Coast learned from past nudges; kept across holds
+static HoldAdapt g_hold_adapt = {1.0f};
+
+// Balance duty the last torque hold ended at; starts the next one when the mass is unknown
+static float g_hold_balance = 0.0f;
+
+// HOLD with holding torque: the duty that balances the load, trimmed by a PI on the
+// (direction-inferred) position error, updated every SPEED_LOOP_DT_S. The direction is judged
+// (slip_direction) when the drum starts to turn and kept until it has been still for a settle
+// time, unless the drum keeps speeding up against the correction: mid-motion the edge trend
+// mostly reflects the hold's own push. The duty is ramped off at the end, like the nudge hold
+// leaves the motor at zero.
+static bool hold_torque_ms(uint32_t hold_ms, bool tow_up_cw) {
+    const uint64_t dt_us = (uint64_t)(SPEED_LOOP_DT_S * 1e6f);
+
+    HoldTorque h;
+    // calibrated duty per kg if there is one, else the motor model's gravity duty
+    float ff = params().payload_kg * params().hold_duty_per_kg;
+    if (params().hold_duty_per_kg == 0.0f) ff = gravity_ff_pct(tow_up_cw);
+    hold_torque_start(h, ff, g_hold_balance);
+
+    bool last_cmd_up = (g_maint.dir_cw == tow_up_cw);
+    absolute_time_t t0 = get_absolute_time();
+    float settle_s = hold_settle_s(g_plant, shaper_duration_s(g_shaper.s));
+
+    set_direction_cw(tow_up_cw);
+    slew_set_target(h.duty, params().slew_rate);
+
+    gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, false);
+    g_fg_pulses = 0;
+    gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, true);
+
+    uint32_t seen = 0;
+    bool turning = false;
+    bool down = true;
+    float judged_duty = h.duty;
+    float slowest_pps = 0.0f, fastest_pps = 0.0f;   // since the judgement / the slowest point
+    uint32_t since_slowest = 0;
+    absolute_time_t last_edge = t0;
+    absolute_time_t end  = make_timeout_time_ms(hold_ms);
+    absolute_time_t next = delayed_by_us(t0, dt_us);
+
+    while (!time_reached(end)) {
+        control_tick();
+
+        if (time_reached(next)) {
+            next = delayed_by_us(next, dt_us);
+
+            uint32_t now = g_fg_pulses;
+            uint32_t n = now - seen;
+            seen = now;
+
+            if (n == 0) {
+                // slow creep is a few edges a second: stopped only once it's been quiet a settle
+                if (absolute_time_diff_us(last_edge, get_absolute_time()) > (int64_t)(settle_s * 1e6f))
+                    turning = false;
+            } else if (!turning) {
+                turning = true;
+                SlipEvidence ev;
+                ev.loaded = params().line_loaded != 0;
+                ev.hold_duty_pct = h.duty;
+                ev.balance_duty_pct = h.ff_duty;
+                ev.friction_duty_pct = g_plant.deadzone_pct;
+                ev.last_cmd_up = last_cmd_up;
+                ev.since_cmd_s = (float)absolute_time_diff_us(t0, get_absolute_time()) * 1e-6f;
+                ev.settle_s = settle_s;
+                ev.rate_trend = fg_edge_trend();
+                down = slip_direction(ev).down;
+                judged_duty = h.duty;
+                slowest_pps = fastest_pps = fg_edge_rate_pps();
+                since_slowest = 0;
+            } else {
+                // The correction should slow it down; still speeding up after the duty moved a
+                // friction's worth against the judged direction means it is going the other way:
+                // the judgement was wrong, or the drum reversed where it was slowest without
+                // pausing. Either way what went by since it was slowest was counted backwards.
+                // Rates rather than the edge trend: a lost edge reads as one interval of slowing
+                // down, which can't fake a new high, and nothing that has been slowing since
+                // its last high is still speeding up.
+                float moved = down ? h.duty - judged_duty : judged_duty - h.duty;
+                float rate = fg_edge_rate_pps();
+                if (rate <= slowest_pps) {
+                    slowest_pps = fastest_pps = rate;
+                    since_slowest = 0;
+                } else if (rate > fastest_pps) {
+                    fastest_pps = rate;
+                    if (moved > g_plant.deadzone_pct && since_slowest >= 3) {
+                        down = !down;
+                        h.err_pulses += 2 * (down ? (int32_t)since_slowest : -(int32_t)since_slowest);
+                        judged_duty = h.duty;
+                        slowest_pps = fastest_pps = rate;
+                        since_slowest = 0;
+                    }
+                }
+            }
+            since_slowest += n;
+            if (n > 0) last_edge = get_absolute_time();
+
+            hold_torque_step(h, n, down, params().hold_kp, params().hold_ki, SPEED_LOOP_DT_S,
+                             params().hold_max_duty);
+            slew_set_target(h.duty, params().slew_rate);
+        }
+
+        uint32_t pulses = g_fg_pulses;
+        absolute_time_t wake = absolute_time_min(next, end);
+        while (g_fg_pulses == pulses && !best_effort_wfe_or_timeout(wake)) {
+        }
+    }
+
+    g_hold_balance = h.balance;
+    printf("[HOLD] torque duty=%.1f balance=%.1f ff=%.1f err=%ld pulses\n",
+           (double)h.duty, (double)h.balance, (double)h.ff_duty, (long)h.err_pulses);
+
+    brake_to_stop(100);
+    return true;
+}
+
+// HOLD: watches FG pulses; if slip occurs, it "nudges" upward by the slipped distance then stops again.
+// Event driven: the core sleeps (WFE) until an FG edge, a housekeeping tick or the end of the
+// hold, so slip is seen on the first edge past the deadband instead of the next 10 ms poll.
+// Nudges are sized from the slip (see hold_control.h) and never start before the previous one
+// has settled (hold_settle_s), nor within min_nudge_gap_ms of it.
+// NOTE: FG has no direction, so the direction of the motion is inferred (slip_direction) and the
+// nudge goes the other way: a payload bumped upward is lowered back instead of pulled further up.
 bool hold_payload_ms(uint32_t hold_ms,
                      bool tow_up_cw,
-                     float nudge_speed_percent = 50.0f,
-                     uint32_t deadband_pulses = 1,
-                     uint32_t nudge_pulses = 80,
-                     uint32_t min_nudge_gap_ms = 250)
+                     float nudge_speed_percent = params().nudge_speed,
+                     uint32_t deadband_pulses = params().deadband_pulses,
+                     uint32_t max_nudge_pulses = params().nudge_max_pulses,
+                     uint32_t min_nudge_gap_ms = params().nudge_min_gap_ms)
 {
+    trace_event(TRACE_EV_HOLD_START);
+    if (params().hold_mode == 1) {
+        bool ok = hold_torque_ms(hold_ms, tow_up_cw);
+        trace_event(TRACE_EV_HOLD_END);
+        return ok;
+    }
+
     brake_to_stop(200);
 
     // Reset pulse counter at start of hold
@@ -233,46 +720,100 @@ bool hold_payload_ms(uint32_t hold_ms,
     g_fg_pulses = 0;
     gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, true);
 
-    absolute_time_t t0 = get_absolute_time();
+    uint64_t settle_us = (uint64_t)(hold_settle_s(g_plant, shaper_duration_s(g_shaper.s)) * 1e6f);
+    if (settle_us < (uint64_t)min_nudge_gap_ms * 1000) settle_us = (uint64_t)min_nudge_gap_ms * 1000;
+
+    absolute_time_t end = make_timeout_time_ms(hold_ms);
     absolute_time_t last_nudge = get_absolute_time();
+    bool last_cmd_up = (g_maint.dir_cw == tow_up_cw);
 
-    while (absolute_time_diff_us(t0, get_absolute_time()) < (int64_t)hold_ms * 1000) {
-        slew_update();
+    while (!time_reached(end)) {
+        control_tick();
 
         // If see pulses while "stopped", the drum is moving (slipping/backdriving)
-        if (g_fg_pulses > deadband_pulses) {
-
-            // Rate-limit nudges so it doesn't chatter too fast
-            if (absolute_time_diff_us(last_nudge, get_absolute_time()) > (int64_t)min_nudge_gap_ms * 1000) {
-
-                // Nudge UP a bit
+        bool slipping = g_fg_pulses > deadband_pulses;
+        absolute_time_t gap_end = delayed_by_us(last_nudge, settle_us);
+
+        if (slipping) {
+
+            // Wait for the last correction to settle so this one sees the whole slip
+            if (time_reached(gap_end)) {
+
+                // Which way it went; nudge back by what slipped, as fast as it slipped
+                SlipEvidence ev;
+                ev.loaded = params().line_loaded != 0;
+                ev.hold_duty_pct = 0.0f;
+                ev.balance_duty_pct = 0.0f;
+                ev.friction_duty_pct = 0.0f;
+                ev.last_cmd_up = last_cmd_up;
+                ev.since_cmd_s = (float)absolute_time_diff_us(last_nudge, get_absolute_time()) * 1e-6f;
+                ev.settle_s = hold_settle_s(g_plant, shaper_duration_s(g_shaper.s));
+                ev.rate_trend = fg_edge_trend();
+                SlipDirection dir = slip_direction(ev);
+
+                g_maint.c.nudges++;
+                trace_event(TRACE_EV_NUDGE);
+                uint32_t slip = g_fg_pulses;
+                NudgePlan plan = nudge_plan(g_plant, g_hold_adapt, slip, fg_edge_rate_pps(),
+                                            nudge_speed_percent, params().brake_rate, max_nudge_pulses);
 
                 gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, false);
                 g_fg_pulses = 0;
                 gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, true);
 
-                set_direction_cw(tow_up_cw);
+                bool nudge_up = dir.down;
+                set_direction_cw(nudge_up ? tow_up_cw : !tow_up_cw);
 
-                slew_set_target(nudge_speed_percent, 400.0f);
+                slew_set_target(plan.duty_pct, 400.0f);
 
-                while (g_fg_pulses < nudge_pulses) {
-                    slew_update();
+                // Stall guard: give up on this nudge if the drum doesn't turn
+                uint32_t ref_pulses = 0;
+                absolute_time_t ref_time = get_absolute_time();
+                while (g_fg_pulses < plan.run_pulses) {
+                    control_tick();
                     tight_loop_contents();
+
+                    if (g_fg_pulses != ref_pulses) {
+                        ref_pulses = g_fg_pulses;
+                        ref_time = get_absolute_time();
+                    } else if (absolute_time_diff_us(ref_time, get_absolute_time()) > (int64_t)params().stall_window_us) {
+                        g_maint.c.stalls++;
+                        trace_event(TRACE_EV_STALL);
+                        printf("[HOLD] nudge stalled after %lu pulses\n", (unsigned long)g_fg_pulses);
+                        break;
+                    }
                 }
 
+                bool stalled = g_fg_pulses < plan.run_pulses;
                 brake_to_stop(200);
 
+                if (!stalled) hold_adapt_update(g_hold_adapt, plan, g_fg_pulses);
+                printf("[HOLD] slip=%lu dir=%s conf=%.2f run=%lu total=%lu duty=%.1f coast_scale=%.2f\n",
+                       (unsigned long)slip, dir.down ? "down" : "up", (double)dir.confidence,
+                       (unsigned long)plan.run_pulses, (unsigned long)g_fg_pulses,
+                       (double)plan.duty_pct, (double)g_hold_adapt.coast_scale);
+
                 gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, false);
                 g_fg_pulses = 0;
                 gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, true);
 
                 last_nudge = get_absolute_time();
+                last_cmd_up = nudge_up;
+                continue;
             }
         }
 
-        sleep_ms(10);
+        // Sleep until the next FG edge, or whichever comes first of: the housekeeping tick,
+        // the end of the settle time (if already slipping) and the end of the hold
+        absolute_time_t wake = absolute_time_min(make_timeout_time_ms(HOLD_TICK_MS), end);
+        if (slipping) wake = absolute_time_min(wake, gap_end);
+
+        uint32_t seen = g_fg_pulses;
+        while (g_fg_pulses == seen && !best_effort_wfe_or_timeout(wake)) {
+        }
     }
 
+    trace_event(TRACE_EV_HOLD_END);
     return true;
 }
 
@@ -289,7 +830,7 @@ static void monitor_fg_for_ms(uint32_t ms, const char* tag = "MON") {
 
     while (absolute_time_diff_us(t0, get_absolute_time()) < (int64_t)ms * 1000) {
         // keep motor command stable during monitor window
-        slew_update();
+        control_tick();
 
         // sample every 200ms
         sleep_ms(200);
@@ -332,7 +873,7 @@ static void fg_hand_spin_test(uint32_t ms,
            wake_percent, ms);
 
     while (absolute_time_diff_us(t0, get_absolute_time()) < (int64_t)ms * 1000) {
-        slew_update();
+        control_tick();
         sleep_ms(200);
 
         uint32_t cur = g_fg_pulses;
@@ -351,6 +892,110 @@ static void fg_hand_spin_test(uint32_t ms,
 }
 
 
+// Move by distance along the least-energy profile that finishes within time_budget_s
+// (0 = whatever is cheapest), see energy_profile.h. The position reference follows the profile;
+// the drum tracks it through the speed loop (or the model feedforward when not tuned), then
+// creeps onto the target if it is still short when the profile ends.
+bool move_meters_eco(bool cw, float meters, float time_budget_s = 0.0f,
+                     int64_t stall_window_us = params().stall_window_us)
+{
+    uint32_t target;
+    if (!target_pulses_for_meters(meters, &target)) return false;
+    if (target == 0) return true;
+
+    const float ppm = g_winch.pulses_per_meter;
+    bool lifting = cw;   // wind = CW, see wind_payload_m
+    float payload_kg = params().line_loaded ? params().payload_kg : 0.0f;
+
+    MotorElec elec = motor_elec_from(g_winch, g_plant);
+    float v_max = speed_for_duty(g_plant, g_winch.v->max_duty_pct) / ppm;
+    float a_max = g_plant.gain_pps_per_pct * params().slew_rate / ppm;
+    MoveProfile prof = energy_optimal_profile(elec, payload_kg, lifting, meters, time_budget_s, v_max, a_max);
+
+    if (prof.time_s == 0.0f) {
+        printf("[ECO] no profile fits %.2f m in %.1f s\n", (double)meters, (double)time_budget_s);
+        return false;
+    }
+    printf("[ECO] T=%.2f s accel=%.2f v=%.2f m/s E=%.1f J peak_duty=%.0f%%\n",
+           (double)prof.time_s, (double)prof.accel_frac, (double)prof.v_peak_mps,
+           (double)prof.energy_j, (double)prof.peak_duty);
+
+    gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, false);
+    g_fg_pulses = 0;
+    gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, true);
+
+    set_direction_cw(cw);
+    g_maint.c.moves++;
+    trace_event(TRACE_EV_MOVE_START);
+
+    const uint64_t dt_us = (uint64_t)(SPEED_LOOP_DT_S * 1e6f);
+    float pos_kp = (params().pos_kp > 0.0f) ? params().pos_kp : 1.0f / (3.0f * g_plant.tau_s);
+    float creep_pps = 0.25f * speed_for_duty(g_plant, params().padding_speed);
+    SpeedLoop speed_loop = {params().speed_kp, params().speed_ki, 0.0f};
+
+    absolute_time_t t0 = get_absolute_time();
+    absolute_time_t next = t0;
+    absolute_time_t stall_ref_time = t0;
+    uint32_t stall_ref_pulses = 0, seen = 0;
+    int64_t timeout_us = (int64_t)((2.0f * prof.time_s + 5.0f) * 1e6f);
+    if (params().closed_loop) ref_shaper_begin(0.0f);
+
+    while (true) {
+        control_tick();
+
+        if (absolute_time_diff_us(t0, get_absolute_time()) > timeout_us) {
+            g_maint.c.timeouts++;
+            trace_event(TRACE_EV_TIMEOUT);
+            brake_to_stop();
+            return false;
+        }
+
+        if (!time_reached(next)) {
+            tight_loop_contents();
+            continue;
+        }
+        next = delayed_by_us(next, dt_us);
+
+        uint32_t now = g_fg_pulses;
+        float meas_pps = (float)(now - seen) / SPEED_LOOP_DT_S;
+        seen = now;
+
+        // stop so the brake coast ends on the target
+        float coast = tune_brake_distance_pulses(g_plant, g_slew.current, params().brake_rate);
+        if ((float)now + coast >= (float)target) break;
+
+        float t = (float)absolute_time_diff_us(t0, get_absolute_time()) * 1e-6f;
+        float pos_ref, v_ref;
+        profile_at(prof, meters, t, &pos_ref, &v_ref);
+
+        float ref_pps = v_ref * ppm + pos_kp * (pos_ref * ppm - (float)now);
+        if (t >= prof.time_s && ref_pps < creep_pps) ref_pps = creep_pps;
+        if (ref_pps < 0.0f) ref_pps = 0.0f;
+
+        float duty = params().closed_loop
+                   ? speed_loop_update(speed_loop, g_plant, ref_shaper_step(ref_pps, (int64_t)dt_us), meas_pps,
+                                       SPEED_LOOP_DT_S, gravity_ff_pct(cw))
+                   : duty_for_speed(g_plant, ref_pps) + gravity_ff_pct(cw);
+        if (duty < 0.0f) duty = 0.0f;
+        slew_set_target(duty, params().slew_rate);
+
+        // Stall: driven above the deadzone but the drum isn't turning
+        if (now != stall_ref_pulses || g_slew.current <= g_plant.deadzone_pct) {
+            stall_ref_pulses = now;
+            stall_ref_time = get_absolute_time();
+        } else if (absolute_time_diff_us(stall_ref_time, get_absolute_time()) > stall_window_us) {
+            g_maint.c.stalls++;
+            trace_event(TRACE_EV_STALL);
+            brake_to_stop();
+            return false;
+        }
+    }
+
+    trace_event(TRACE_EV_MOVE_END);
+    brake_to_stop();
+    return true;
+}
+
 // Public API
 bool unwind_payload_m(float meters, float speed_percent = 40.0f) {
     // unwind = CCW (cw=false). Flip if your wiring/spool is opposite.
@@ -362,7 +1007,791 @@ bool wind_payload_m(float meters, float speed_percent = 60.0f) {
     return move_meters(true, meters, speed_percent, 60000);
 }
 
-int main() {
+// ---- Rangefinder / lower to height ----
+
+enum RangeSource : uint32_t {
+    RANGE_SRC_OFF  = 0,
+    RANGE_SRC_UART = 1,   // TFmini / TF-Luna frames (rangefinder.h), 115200 8N1
+    RANGE_SRC_I2C  = 2,   // Garmin LIDAR-Lite v3
+};
+
+#define RANGE_UART      uart1
+#define RANGE_I2C       i2c0
+#define LIDARLITE_ADDR  0x62
+
+static struct {
+    uint32_t source;          // as initialised at boot
+    RangeParser parser;
+    bool i2c_triggered;
+    absolute_time_t i2c_t;
+} g_range;
+
+static void range_init() {
+    g_range.source = params().range_source;
+
+    if (g_range.source == RANGE_SRC_UART) {
+        uart_init(RANGE_UART, 115200);
+        gpio_set_function(RANGE_PIN_A, GPIO_FUNC_UART);
+        gpio_set_function(RANGE_PIN_B, GPIO_FUNC_UART);
+    } else if (g_range.source == RANGE_SRC_I2C) {
+        i2c_init(RANGE_I2C, 400000);
+        gpio_set_function(RANGE_PIN_A, GPIO_FUNC_I2C);
+        gpio_set_function(RANGE_PIN_B, GPIO_FUNC_I2C);
+        gpio_pull_up(RANGE_PIN_A);
+        gpio_pull_up(RANGE_PIN_B);
+    }
+}
+
+// Non-blocking: true when a new reading (m, sensor frame) is available
+static bool range_poll(float* dist_m) {
+    if (g_range.source == RANGE_SRC_UART) {
+        bool got = false;
+        while (uart_is_readable(RANGE_UART)) {
+            float d;
+            if (range_parse_byte(g_range.parser, (uint8_t)uart_getc(RANGE_UART), &d)) {
+                *dist_m = d;
+                got = true;
+            }
+        }
+        return got;
+    }
+
+    if (g_range.source == RANGE_SRC_I2C) {
+        // acquire (reg 0x00 <- 0x04), then read 0x8f (cm, big endian) ~20 ms later
+        if (!g_range.i2c_triggered) {
+            uint8_t cmd[2] = {0x00, 0x04};
+            if (i2c_write_timeout_us(RANGE_I2C, LIDARLITE_ADDR, cmd, 2, false, 1000) != 2) return false;
+            g_range.i2c_triggered = true;
+            g_range.i2c_t = make_timeout_time_ms(20);
+            return false;
+        }
+        if (!time_reached(g_range.i2c_t)) return false;
+        g_range.i2c_triggered = false;
+
+        uint8_t reg = 0x8f, buf[2];
+        if (i2c_write_timeout_us(RANGE_I2C, LIDARLITE_ADDR, &reg, 1, true, 1000) != 1) return false;
+        if (i2c_read_timeout_us(RANGE_I2C, LIDARLITE_ADDR, buf, 2, false, 1000) != 2) return false;
+
+        uint16_t cm = (uint16_t)((buf[0] << 8) | buf[1]);
+        if (cm == 0) return false;
+        *dist_m = (float)cm * 0.01f;
+        return true;
+    }
+
+    return false;
+}
+
+// Payload height above ground (m) from the next reading within timeout_ms
+static bool range_read_height(float* h_m, uint32_t timeout_ms = 500) {
+    absolute_time_t end = make_timeout_time_ms(timeout_ms);
+    while (!time_reached(end)) {
+        float d;
+        if (range_poll(&d)) {
+            *h_m = d - params().range_offset_m;
+            return true;
+        }
+        control_tick();
+    }
+    return false;
+}
+
+// Unwind until the payload is target_m above the ground: full speed while far, then a
+// constant-deceleration approach, stopping so the brake coast ends on the target.
+// Height comes from the rangefinder fused with line-out (rangefinder.h), so missing or bad
+// readings don't stop the descent.
+bool lower_to_height_m(float target_m, float speed_percent = 100.0f, uint32_t timeout_ms = 60000) {
+    if (g_range.source == RANGE_SRC_OFF) {
+        printf("[RANGE] range_source is off\n");
+        return false;
+    }
+
+    float z;
+    if (!range_read_height(&z)) {
+        printf("[RANGE] no reading\n");
+        return false;
+    }
+
+    HeightFusion fusion;
+    height_reset(fusion);
+    height_correct(fusion, z);
+    if (fusion.h <= target_m) return true;
+
+    const float ppm = g_winch.pulses_per_meter;
+    const uint64_t dt_us = (uint64_t)(SPEED_LOOP_DT_S * 1e6f);
+    float v_max = speed_for_duty(g_plant, speed_percent) / ppm;
+
+    gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, false);
+    g_fg_pulses = 0;
+    gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, true);
+
+    set_direction_cw(false);   // unwind, as unwind_payload_m
+    g_maint.c.moves++;
+    trace_event(TRACE_EV_MOVE_START);
+
+    SpeedLoop speed_loop = {params().speed_kp, params().speed_ki, 0.0f};
+    absolute_time_t t0 = get_absolute_time();
+    absolute_time_t next = t0;
+    absolute_time_t stall_ref_time = t0;
+    uint32_t stall_ref_pulses = 0, seen = 0;
+    bool ok = false;
+    if (params().closed_loop) ref_shaper_begin(0.0f);
+
+    while (true) {
+        control_tick();
+
+        if (absolute_time_diff_us(t0, get_absolute_time()) > (int64_t)timeout_ms * 1000) {
+            g_maint.c.timeouts++;
+            trace_event(TRACE_EV_TIMEOUT);
+            break;
+        }
+        if ((float)g_maint.c.line_out_pulses / ppm >= g_winch.v->max_line_m) {
+            // traced as a timeout: the move gave up before arriving, with the drum still turning
+            printf("[RANGE] out of line at h=%.2f\n", (double)fusion.h);
+            trace_event(TRACE_EV_TIMEOUT);
+            break;
+        }
+
+        if (range_poll(&z)) height_correct(fusion, z - params().range_offset_m);
+
+        if (!time_reached(next)) {
+            tight_loop_contents();
+            continue;
+        }
+        next = delayed_by_us(next, dt_us);
+
+        uint32_t now = g_fg_pulses;
+        float meas_pps = (float)(now - seen) / SPEED_LOOP_DT_S;
+        height_predict(fusion, (float)(now - seen) / ppm);
+        seen = now;
+
+        float stop_m = tune_brake_distance_pulses(g_plant, g_slew.current, params().brake_rate) / ppm;
+        if (fusion.h - stop_m <= target_m) {
+            ok = true;
+            break;
+        }
+
+        float v = descent_speed_mps(fusion.h, target_m, stop_m, v_max,
+                                    params().descent_decel, params().descent_creep);
+        float duty = params().closed_loop
+                   ? speed_loop_update(speed_loop, g_plant, ref_shaper_step(v * ppm, (int64_t)dt_us), meas_pps,
+                                       SPEED_LOOP_DT_S, gravity_ff_pct(false))
+                   : duty_for_speed(g_plant, v * ppm) + gravity_ff_pct(false);
+        if (duty < 0.0f) duty = 0.0f;
+        slew_set_target(duty, params().slew_rate);
+
+        // Stall: driven above the deadzone but the drum isn't turning
+        if (now != stall_ref_pulses || g_slew.current <= g_plant.deadzone_pct) {
+            stall_ref_pulses = now;
+            stall_ref_time = get_absolute_time();
+        } else if (absolute_time_diff_us(stall_ref_time, get_absolute_time()) > (int64_t)params().stall_window_us) {
+            g_maint.c.stalls++;
+            trace_event(TRACE_EV_STALL);
+            break;
+        }
+    }
+
+    if (ok) trace_event(TRACE_EV_MOVE_END);
+    brake_to_stop();
+    height_predict(fusion, (float)(g_fg_pulses - seen) / ppm);
+    if (range_read_height(&z, 100)) height_correct(fusion, z);
+
+    printf("[RANGE] %s h=%.3f target=%.3f\n", ok ? "arrived" : "aborted", (double)fusion.h, (double)target_m);
+    return ok;
+}
+
+// ---- Parameter persistence ----
+
+static void params_save() {
+    static ParamRecord rec;
+    const ParamSet& s = param_bank_latest(g_param_bank);   // includes a commit not live yet
+    params_to_record(s, rec);
+
+    // The variant's safe rates are seeded at boot; stored, they would outlive a variant change.
+    // Only rates set away from them are kept.
+    if (s.slew_rate == g_winch.v->safe_slew_rate)   param_record_drop(rec, "slew_rate");
+    if (s.brake_rate == g_winch.v->safe_brake_rate) param_record_drop(rec, "brake_rate");
+    store_save(STORE_SLOT_PARAMS, STORE_KIND_PARAMS, &rec, sizeof(rec));
+}
+
+static bool params_load(ParamSet& out) {
+    static ParamRecord rec;
+    if (!store_load(STORE_SLOT_PARAMS, STORE_KIND_PARAMS, &rec, sizeof(rec))) return false;
+    return params_from_record(out, rec) > 0;
+}
+
+// Pick the variant (stored choice wins over the build default), derive its constants once and
+// seed the parameter set with its safe limits before applying saved overrides (params_save
+// only stores rates that differ from the safe ones).
+static void winch_select() {
+    ParamSet stored;
+    params_defaults(stored);
+    bool have_stored = params_load(stored);
+
+    g_winch = winch_derive(stored.variant);
+    g_plant = plant_default_params(g_winch.full_speed_pps, g_winch.pulses_per_meter);
+    gain_schedule_configure();
+
+    param_bank_init(g_param_bank);
+    ParamSet& st = g_param_bank.staging;
+    st.variant    = stored.variant;
+    st.slew_rate  = g_winch.v->safe_slew_rate;
+    st.brake_rate = g_winch.v->safe_brake_rate;
+    if (have_stored) params_load(st);
+    params_commit_now();
+
+    printf("[WINCH] %s: %.1f pulses/m, %.2f m/s max line speed%s\n",
+           g_winch.v->name, g_winch.pulses_per_meter, g_winch.max_line_speed_mps,
+           have_stored ? " (stored parameters)" : "");
+}
+
+// ---- Plant identification + autotune ----
+
+// One duty step from rest. Position settles onto v * (t - tau) for a first-order plant,
+// so steady speed comes from the tail slope and tau from the line's time-axis intercept.
+static bool identify_step(float duty, uint32_t step_ms, float* speed_pps, float* tau_s) {
+    gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, false);
+    g_fg_pulses = 0;
+    gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, true);
+
+    slew_init(duty); // true step, no slew
+
+    absolute_time_t t0 = get_absolute_time();
+    uint32_t tail_pulses = 0;
+    int64_t tail_us = (int64_t)step_ms * 2000 / 3;
+    bool tail_started = false;
+
+    while (absolute_time_diff_us(t0, get_absolute_time()) < (int64_t)step_ms * 1000) {
+        if (!tail_started && absolute_time_diff_us(t0, get_absolute_time()) >= tail_us) {
+            tail_pulses = g_fg_pulses;
+            tail_started = true;
+        }
+        tight_loop_contents();
+    }
+
+    uint32_t end_pulses = g_fg_pulses;
+    brake_to_stop(300);
+
+    float tail_s = (float)step_ms / 3000.0f;
+    float v = (float)(end_pulses - tail_pulses) / tail_s;
+    if (v <= 0) return false;
+
+    *speed_pps = v;
+    *tau_s = (float)step_ms / 1000.0f - (float)end_pulses / v;
+    return true;
+}
+
+// Unwinds in two duty steps, fits gain/deadzone/tau, then winds the same line back in
+static bool identify_plant(PlantParams& out, float duty_lo = 30.0f, float duty_hi = 60.0f,
+                           uint32_t step_ms = 600)
+{
+    set_direction_cw(false);
+
+    float v_lo, v_hi, tau_lo, tau_hi;
+    bool ok_lo = identify_step(duty_lo, step_ms, &v_lo, &tau_lo);
+    uint32_t paid_out = g_fg_pulses;
+
+    bool ok_hi = identify_step(duty_hi, step_ms, &v_hi, &tau_hi);
+    paid_out += g_fg_pulses;
+
+    // Bring the payload back to where it started
+    move_meters(true, (float)paid_out / g_winch.pulses_per_meter, 40.0f, 60000);
+
+    if (!ok_lo || !ok_hi || v_hi <= v_lo) return false;
+
+    PlantParams p;
+    p.gain_pps_per_pct = (v_hi - v_lo) / (duty_hi - duty_lo);
+    p.deadzone_pct     = duty_lo - v_lo / p.gain_pps_per_pct;
+    p.tau_s            = 0.5f * (tau_lo + tau_hi);
+    p.pulses_per_meter = g_winch.pulses_per_meter;
+
+    if (!plant_params_sane(p)) return false;
+
+    out = p;
+    return true;
+}
+
+static bool autotune_run(const TuneSpec& spec, bool identify = true) {
+    if (identify) {
+        PlantParams p;
+        if (!identify_plant(p)) {
+            printf("[TUNE] Identification failed, keeping current model\n");
+            return false;
+        }
+        g_plant = p;
+    }
+
+    printf("[TUNE] Plant gain=%.2f pps/%% tau=%.3f s deadzone=%.1f %%\n",
+           g_plant.gain_pps_per_pct, g_plant.tau_s, g_plant.deadzone_pct);
+
+    TuneResult r = autotune_compute(g_plant, spec);
+
+    printf("[TUNE] kp=%.4f ki=%.4f pos_kp=%.3f slew=%.0f brake=%.0f pad=%.3f m @ %.1f %%\n",
+           r.speed_kp, r.speed_ki, r.pos_kp, r.slew_rate, r.brake_rate, r.padding_m, r.padding_speed);
+    if (r.speed_kp == 0.0f) {
+        printf("[TUNE] settle %.2f s can't be placed: the plant settles in %.2f s on feedforward alone, "
+               "speed loop is an integral trim (kp=0)\n", spec.settle_s, 3.0f * g_plant.tau_s);
+    }
+    printf("[TUNE] sim overshoot=%.1f %% settle=%.3f s stop_err=%.4f m -> %s\n",
+           r.sim_overshoot_pct, r.sim_settle_s, r.sim_stop_error_m, r.valid ? "OK" : "REJECTED");
+
+    if (!r.valid) return false;
+
+    g_tune = r;
+    gain_schedule_configure(spec);
+
+    TuneRecord rec = {g_plant, g_tune};
+    store_save(STORE_SLOT_TUNE, STORE_KIND_TUNE, &rec, sizeof(rec));
+
+    // Apply through the registry so the result is visible/editable like any other parameter;
+    // edits waiting in staging stay staged, only the tuned fields are written over them
+    ParamSet live = params();
+    ParamSet* sets[2] = {&live, &g_param_bank.staging};
+    for (ParamSet* st : sets) {
+        st->padding_m     = r.padding_m;
+        st->padding_speed = r.padding_speed;
+        st->slew_rate     = r.slew_rate;
+        st->brake_rate    = r.brake_rate;
+        st->speed_kp      = r.speed_kp;
+        st->speed_ki      = r.speed_ki;
+        st->pos_kp        = r.pos_kp;
+        st->closed_loop   = 1;
+    }
+    params_commit_result(live);
+
+    params_save();
+    return true;
+}
+
+static bool tune_load() {
+    TuneRecord rec;
+    if (!store_load(STORE_SLOT_TUNE, STORE_KIND_TUNE, &rec, sizeof(rec))) return false;
+    if (!plant_params_sane(rec.plant) || !rec.tune.valid) return false;
+
+    // tuned for a different drum/gearbox
+    if (fabsf(rec.plant.pulses_per_meter - g_winch.pulses_per_meter) > 0.01f) return false;
+
+    g_plant = rec.plant;
+    g_tune  = rec.tune;
+    gain_schedule_configure();
+    return true;
+}
+
+// ---- Swing damping ----
+
+enum SwingSource : uint32_t {
+    SWING_SRC_OFF     = 0,
+    SWING_SRC_LINK    = 1,   // "swing <theta_rad> <rate_rad_s>" from the flight controller IMU
+    SWING_SRC_TENSION = 2,   // load cell on TENSION_ADC_PIN
+};
+
+static constexpr int64_t SWING_LINK_STALE_US = 200000;
+
+static struct {
+    float theta = 0.0f;
+    float rate = 0.0f;
+    absolute_time_t t = {0};
+} g_swing_link;
+
+// Modulate line length against the swing for ms, then stop. Line stays within
+// swing_max_exc of where it started.
+static bool damp_swing_ms(uint32_t ms) {
+    uint32_t source = params().swing_source;
+    if (source == SWING_SRC_OFF) return false;
+
+    SwingDamperCfg cfg;
+    cfg.mod_rate_mps    = params().swing_mod_rate;
+    cfg.min_angle_rad   = params().swing_min_angle;
+    cfg.min_ripple      = params().swing_min_ripple;
+    cfg.max_excursion_m = params().swing_max_exc;
+    cfg.pos_kp          = params().swing_pos_kp;
+
+    const float ppm = g_winch.pulses_per_meter;
+    int32_t line0 = g_maint.c.line_out_pulses;
+
+    // tension mean over ~2 s, ripple envelope from mean |relative deviation| * pi/2
+    float t_mean = (float)adc_read(), ripple = 0.0f;
+
+    ReversingDrive drive = {true};
+    set_direction_cw(false);      // pay out = unwind = CCW
+    slew_set_target(0.0f, params().slew_rate);
+
+    absolute_time_t t0 = get_absolute_time();
+    absolute_time_t last = t0;
+
+    while (absolute_time_diff_us(t0, get_absolute_time()) < (int64_t)ms * 1000) {
+        control_tick();
+
+        int64_t dt_us = absolute_time_diff_us(last, get_absolute_time());
+        if (dt_us < (int64_t)(SPEED_LOOP_DT_S * 1e6f)) continue;
+        last = get_absolute_time();
+
+        float dt_s = (float)dt_us / 1e6f;
+        float line_m = (float)g_maint.c.line_out_pulses / ppm;
+        float excursion_m = (float)(g_maint.c.line_out_pulses - line0) / ppm;
+        float rate;
+
+        if (source == SWING_SRC_TENSION) {
+            float t = (float)adc_read();
+            t_mean += (t - t_mean) * (dt_s / 2.0f);
+            if (t_mean > 0.0f) ripple += (fabsf(t / t_mean - 1.0f) * 1.5708f - ripple) * (dt_s / 2.0f);
+            rate = swing_rate_from_tension(cfg, t, t_mean, ripple, excursion_m);
+        } else {
+            bool fresh = absolute_time_diff_us(g_swing_link.t, get_absolute_time()) < SWING_LINK_STALE_US;
+            rate = swing_rate_from_angle(cfg, fresh ? g_swing_link.theta : 0.0f,
+                                         fresh ? g_swing_link.rate : 0.0f, line_m, excursion_m);
+        }
+
+        float duty = reversing_drive_step(drive, g_plant, rate, g_slew.current);
+        if (drive.paying_out == g_maint.dir_cw) set_direction_cw(!drive.paying_out);
+        slew_set_target(duty, params().slew_rate);
+    }
+
+    brake_to_stop(200);
+    return true;
+}
+
+// ---- Bounce mode identification ----
+
+// Short unshaped unwind with an abrupt stop to ring the payload, then bin the FG pulses the
+// bounce produces for 2 s and take the mode from their ripple. Winds the line back after.
+static bool shaper_identify(float* f_hz) {
+    static constexpr uint32_t BINS = 200;
+    static constexpr uint32_t BIN_MS = 10;
+    static uint16_t bins[BINS];
+
+    ParamSet live = params();
+    uint32_t mode = live.shaper_mode;
+    live.shaper_mode = SHAPER_OFF;
+    params_commit_result(live);
+
+    move_meters(false, 0.15f, params().padding_speed, 10000);
+
+    gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, false);
+    g_fg_pulses = 0;
+    gpio_set_irq_enabled(FG_PIN, GPIO_IRQ_EDGE_RISE, true);
+
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < BINS; i++) {
+        absolute_time_t t0 = get_absolute_time();
+        while (absolute_time_diff_us(t0, get_absolute_time()) < (int64_t)BIN_MS * 1000) {
+            control_tick();
+        }
+        uint32_t cur = g_fg_pulses;
+        bins[i] = (uint16_t)(cur - last);
+        last = cur;
+    }
+    uint32_t total = last;
+
+    live = params();
+    live.shaper_mode = mode;
+    params_commit_result(live);
+
+    // bounce pulses have no direction; assume they were payout (gravity side)
+    move_meters(true, 0.15f + (float)total / g_winch.pulses_per_meter, params().padding_speed, 10000);
+
+    float f = ripple_mode_hz(bins, BINS, BIN_MS / 1000.0f);
+    printf("[SHAPER] bounce pulses=%lu mode=%.2f Hz\n", (unsigned long)total, f);
+
+    if (total < 8 || f <= 0.0f) {
+        printf("[SHAPER] no usable ripple, keeping %.2f Hz\n", params().shaper_freq_hz);
+        return false;
+    }
+
+    *f_hz = f;
+    return true;
+}
+
+// ---- Command link ----
+
+static LineBuffer g_cmd_line;
+static char g_cmd_deferred[CMD_LINE_MAX];   // waits for idle: flash writes and motion
+
+static bool command_needs_idle(int argc, char** argv) {
+    if (strcmp(argv[0], "tune") == 0) return true;
+    if (strcmp(argv[0], "damp") == 0) return true;
+    if (strcmp(argv[0], "shaper") == 0) return true;
+    if (strcmp(argv[0], "lower") == 0) return true;
+    if (strcmp(argv[0], "move") == 0) return true;
+    if (strcmp(argv[0], "range") == 0) return true;
+    if (argc >= 2 && strcmp(argv[0], "trace") == 0 && strcmp(argv[1], "dump") == 0) return true;
+    if (argc >= 2 && strcmp(argv[1], "save") == 0) {
+        return strcmp(argv[0], "param") == 0 || strcmp(argv[0], "maint") == 0;
+    }
+    return false;
+}
+
+// Calibrations that read what the last motion left behind: rejected while one is running,
+// since deferring them would read the next one instead
+static bool command_needs_stopped(int argc, char** argv) {
+    return argc >= 2 && strcmp(argv[0], "hold") == 0 && strcmp(argv[1], "cal") == 0;
+}
+
+static bool command_execute(int argc, char** argv) {
+    if (strcmp(argv[0], "param") == 0) {
+        if (argc == 2 && strcmp(argv[1], "save") == 0) {
+            params_save();
+            printf("[PARAM] saved\n");
+            return true;
+        }
+        if (argc == 2 && strcmp(argv[1], "load") == 0) {
+            if (!params_load(g_param_bank.staging)) return false;
+            printf("[PARAM] loaded into staging (commit to apply)\n");
+            return true;
+        }
+        return params_command(g_param_bank, argc, argv);
+    }
+
+    if (strcmp(argv[0], "maint") == 0) {
+        // maint | maint save | maint line_zero
+        if (argc == 1) {
+            maint_print(g_maint.c, g_winch.v->fg_pulses_per_motor_rev, g_winch.pulses_per_meter);
+            return true;
+        }
+        if (argc == 2 && strcmp(argv[1], "save") == 0) {
+            maint_save();
+            printf("[MAINT] saved\n");
+            return true;
+        }
+        if (argc == 2 && strcmp(argv[1], "line_zero") == 0) {
+            // payload is fully wound: re-reference line-out for the segment counts
+            g_maint.c.line_out_pulses = 0;
+            g_maint.dirty = true;
+            return true;
+        }
+        return false;
+    }
+
+    if (strcmp(argv[0], "wear") == 0) {
+        // wear | wear reset (after replacing the line)
+        if (argc == 1) {
+            wear_print(g_maint.wear, params().wear_alert_passes);
+            return true;
+        }
+        if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+            wear_reset(g_maint.wear);
+            g_maint.dirty = true;
+            printf("[WEAR] reset\n");
+            return true;
+        }
+        return false;
+    }
+
+    if (strcmp(argv[0], "swing") == 0 && argc == 3) {
+        // swing <theta_rad> <rate_rad_s>: latest swing estimate, expected at >= 10 Hz
+        float theta, rate;
+        if (!arg_float(argv[1], -1.6f, 1.6f, &theta) || !arg_float(argv[2], -20.0f, 20.0f, &rate)) return false;
+        g_swing_link.theta = theta;
+        g_swing_link.rate  = rate;
+        g_swing_link.t     = get_absolute_time();
+        return true;
+    }
+
+    if (strcmp(argv[0], "damp") == 0 && argc == 2) {
+        // damp <ms>: active swing damping at the current line length
+        uint32_t ms;
+        if (!arg_u32(argv[1], 1, 3600000, &ms)) return false;
+        if (!damp_swing_ms(ms)) printf("[SWING] swing_source is off\n");
+        return true;
+    }
+
+    if (strcmp(argv[0], "shaper") == 0) {
+        // shaper ident: measure the bounce mode and use it
+        if (argc != 2 || strcmp(argv[1], "ident") != 0) return false;
+
+        float f_hz;
+        if (!shaper_identify(&f_hz)) return true;
+
+        const ParamDef& d = *param_find("shaper_freq_hz");
+        ParamSet live = params();
+        if (!param_set(live, d, f_hz)) return false;
+        param_set(g_param_bank.staging, d, f_hz);
+        params_commit_result(live);
+        printf("[SHAPER] freq set to %.2f Hz (param save to keep)\n", f_hz);
+        return true;
+    }
+
+    if (strcmp(argv[0], "range") == 0) {
+        // range: one height reading
+        float h;
+        if (!range_read_height(&h)) return false;
+        printf("[RANGE] h=%.3f\n", (double)h);
+        return true;
+    }
+
+    if (strcmp(argv[0], "lower") == 0 && argc >= 2) {
+        // lower <height_m> [speed%]: unwind until the payload is that high above the ground
+        float target, speed = 100.0f;
+        if (!arg_float(argv[1], 0.0f, g_winch.v->max_line_m, &target)) return false;
+        if (argc > 2 && !arg_float(argv[2], 1.0f, 100.0f, &speed)) return false;
+
+        lower_to_height_m(target, speed);
+        return true;
+    }
+
+    if (strcmp(argv[0], "move") == 0 && argc >= 3) {
+        // move <in|out> <m> [eco [budget_s]]: fixed speed bands, or the least-energy profile
+        bool in = strcmp(argv[1], "in") == 0;
+        if (!in && strcmp(argv[1], "out") != 0) return false;
+        float m;
+        if (!arg_float(argv[2], 0.001f, g_winch.v->max_line_m, &m)) return false;
+
+        if (argc >= 4 && strcmp(argv[3], "eco") == 0) {
+            float budget = 0.0f;
+            if (argc > 4 && !arg_float(argv[4], 0.0f, 3600.0f, &budget)) return false;
+            move_meters_eco(in, m, budget);
+        } else {
+            if (in) wind_payload_m(m);
+            else    unwind_payload_m(m);
+        }
+        return true;
+    }
+
+    if (strcmp(argv[0], "hold") == 0) {
+        // hold cal <kg>: the last torque hold balanced <kg>, derive the duty per kg from it
+        if (argc != 3 || strcmp(argv[1], "cal") != 0) return false;
+
+        float kg;
+        if (!arg_float(argv[2], 0.01f, 1000.0f, &kg) || !(g_hold_balance > 0.0f)) return false;
+
+        const ParamDef& kg_d = *param_find("payload_kg");
+        const ParamDef& per_d = *param_find("hold_duty_per_kg");
+        ParamSet live = params();
+        if (!param_set(live, kg_d, kg) || !param_set(live, per_d, g_hold_balance / kg)) return false;
+        param_set(g_param_bank.staging, kg_d, kg);
+        param_set(g_param_bank.staging, per_d, g_hold_balance / kg);
+        params_commit_result(live);
+        printf("[HOLD] duty_per_kg=%.3f from balance=%.1f (param save to keep)\n",
+               (double)(g_hold_balance / kg), (double)g_hold_balance);
+        return true;
+    }
+
+    if (strcmp(argv[0], "trace") == 0) {
+        // trace | trace on (restarts the buffer) | trace off | trace dump (hex, for trace_tool import)
+        if (argc == 1) {
+            uint32_t len = g_trace.len, records = g_trace.records;
+            printf("[TRACE] on=%d records=%lu bytes=%lu/%lu full=%d ratio=%.1f\n",
+                   (int)g_trace_on, (unsigned long)records, (unsigned long)len,
+                   (unsigned long)TRACE_RAM_BYTES, (int)g_trace.full,
+                   len ? (double)records * sizeof(TraceRecord) / len : 0.0);
+            return true;
+        }
+        if (argc == 2 && strcmp(argv[1], "on") == 0) {
+            trace_start();
+            return true;
+        }
+        if (argc == 2 && strcmp(argv[1], "off") == 0) {
+            g_trace_on = false;
+            return true;
+        }
+        if (argc == 2 && strcmp(argv[1], "dump") == 0) {
+            // the buffer only grows, so everything below this length is final
+            uint32_t len = g_trace.len;
+            for (uint32_t off = 0; off < len; off += 32) {
+                printf("[TRACE] hex %05lx ", (unsigned long)off);
+                for (uint32_t i = off; i < len && i < off + 32; i++) printf("%02x", g_trace_buf[i]);
+                printf("\n");
+            }
+            printf("[TRACE] end bytes=%lu\n", (unsigned long)len);
+            return true;
+        }
+        return false;
+    }
+
+    if (strcmp(argv[0], "tune") == 0) {
+        // tune [settle_s] [overshoot_pct] [stop_tol_m]
+        TuneSpec spec = tune_default_spec();
+        if (argc > 1 && !arg_float(argv[1], 0.05f, 10.0f, &spec.settle_s))      return false;
+        if (argc > 2 && !arg_float(argv[2], 0.0f, 90.0f, &spec.overshoot_pct))  return false;
+        if (argc > 3 && !arg_float(argv[3], 0.001f, 1.0f, &spec.stop_tol_m))    return false;
+
+        autotune_run(spec);
+        return true;
+    }
+
+    return false;
+}
+
+static void command_line(char* line, bool idle) {
+    char copy[CMD_LINE_MAX];
+    strcpy(copy, line);
+
+    char* argv[CMD_ARGS_MAX];
+    int argc = split_args(line, argv, CMD_ARGS_MAX);
+    if (argc == 0) return;
+
+    if (!idle && command_needs_stopped(argc, argv)) {
+        printf("[ERR] busy: %s\n", argv[0]);
+        return;
+    }
+
+    if (!idle && command_needs_idle(argc, argv)) {
+        if (g_cmd_deferred[0]) {
+            printf("[ERR] busy: %s\n", argv[0]);
+        } else {
+            strcpy(g_cmd_deferred, copy);
+        }
+        return;
+    }
+
+    if (!command_execute(argc, argv)) printf("[ERR] bad command: %s\n", copy);
+}
+
+// Non-blocking: drains whatever arrived on USB stdio
+static void command_poll(bool idle) {
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (line_feed(g_cmd_line, c)) command_line(g_cmd_line.buf, idle);
+    }
+
+    if (idle && g_cmd_deferred[0]) {
+        char line[CMD_LINE_MAX];
+        strcpy(line, g_cmd_deferred);
+        g_cmd_deferred[0] = '\0';
+        command_line(line, true);
+    }
+}
+
+// Wait without motion while keeping the command link serviced; flushes counters now and then
+static void idle_ms(uint32_t ms) {
+    absolute_time_t t0 = get_absolute_time();
+    while (absolute_time_diff_us(t0, get_absolute_time()) < (int64_t)ms * 1000) {
+        control_tick(true);
+
+        if (g_maint.dirty && g_slew.current == 0.0f &&
+            absolute_time_diff_us(g_maint.last_flush, get_absolute_time()) >
+                (int64_t)MAINT_FLUSH_INTERVAL_MS * 1000) {
+            maint_save();
+        }
+
+        sleep_ms(1);
+    }
+}
+
+static void maint_init() {
+    if (!store_load(STORE_SLOT_MAINT, STORE_KIND_MAINT, &g_maint.c, sizeof(g_maint.c))) {
+        maint_reset(g_maint.c);
+    }
+    if (!store_load(STORE_SLOT_WEAR, STORE_KIND_WEAR, &g_maint.wear, sizeof(g_maint.wear))) {
+        wear_reset(g_maint.wear);
+    }
+    g_maint.c.boots++;
+    g_maint.last_total = g_fg_total;
+    g_maint.last_t = get_absolute_time();
+    g_maint.last_flush = g_maint.last_t;
+    g_maint.dirty = true;
+
+    maint_print(g_maint.c, g_winch.v->fg_pulses_per_motor_rev, g_winch.pulses_per_meter);
+
+    // Remind at every boot while a segment is over the limit
+    uint32_t limit = params().wear_alert_passes;
+    for (uint32_t k = 0; limit > 0 && k < WEAR_SEG_COUNT; k++) {
+        if (wear_passes(g_maint.wear, k) >= limit) wear_print_alert(g_maint.wear, (int32_t)k);
+    }
+}
+
+// Pins, PWM and ADC, then variant + parameters, counters and rangefinder: everything before the
+// first motion (Host-Tools/sitl.h boots the firmware through this too)
+static void board_init() {
     stdio_init_all();
 
     // DIR pin
@@ -381,19 +1810,40 @@ int main() {
     // PWM init
     pwm_init_motor();
 
-    sleep_ms(5000);
+    // Tension input for swing damping (reads mid-scale noise if nothing is connected)
+    adc_init();
+    adc_gpio_init(TENSION_ADC_PIN);
+    adc_select_input(TENSION_ADC_PIN - 26);
+
+    // Variant + parameters: table defaults, then variant defaults, then whatever was saved
+    winch_select();
+    maint_init();
+    range_init();
+}
+
+int main() {
+    board_init();
+
+    idle_ms(5000);
+
+    // Stored tune from a previous autotune, if any
+    if (tune_load()) {
+        printf("[TUNE] Loaded stored tune\n");
+    } else if (AUTOTUNE_IF_MISSING) {
+        autotune_run(tune_default_spec());
+    }
 
     while (true) {
-        // Example cycle:
-        // Unwind 0.5m, hold 5s, wind 0.5m, pause
-        unwind_payload_m(0.6f, 100.0f);
-        
-        // Hold 5 seconds (wind/tow up direction is CW=true)
-        hold_payload_ms(2000, /*tow_up_cw=*/true);
+        // Mission cycle (cycle_* params, see Host-Tools/cycle_opt):
+        // unwind, hold, wind back, pause
+        unwind_payload_m(params().cycle_m, params().cycle_speed);
+
+        // Hold (wind/tow up direction is CW=true)
+        hold_payload_ms(params().cycle_hold_ms, /*tow_up_cw=*/true);
 
-        wind_payload_m(0.6f, 100.0f);
+        wind_payload_m(params().cycle_m, params().cycle_speed);
 
-        sleep_ms(5000);
+        idle_ms(params().cycle_pause_ms);
         
         // // Test to see if pulses are detected when hand-spinning the drum with driver "awake" at low speed
         // bool ok = unwind_payload_m(0.3f, 100.0f);
@@ -0,0 +1,222 @@
+#pragma once
+
+// Controller autotuning from the plant model.
+// Gains come from pole placement on the first-order plant; every candidate is run through
+// an internal simulation of the same control law the firmware uses before it is accepted.
+
+#include <math.h>
+#include <stdint.h>
+#include "winch_model.h"
+#include "control_law.h"
+
+struct TuneSpec {
+    float settle_s;       // 5 % settling time wanted from the speed loop
+    float overshoot_pct;  // allowed speed overshoot
+    float stop_tol_m;     // allowed stop error at the end of a move
+    float cruise_pct;     // cruise duty the profile is tuned for
+    float test_move_m;    // move length used for validation
+};
+
+static inline TuneSpec tune_default_spec() {
+    TuneSpec s;
+    s.settle_s      = 0.5f;
+    s.overshoot_pct = 5.0f;
+    s.stop_tol_m    = 0.01f;
+    s.cruise_pct    = 100.0f;
+    s.test_move_m   = 0.6f;
+    return s;
+}
+
+struct TuneResult {
+    float speed_kp;          // % duty per pulse/s of speed error
+    float speed_ki;          // % duty per pulse of integrated speed error
+    float pos_kp;            // pulse/s of speed reference per pulse remaining
+    float slew_rate;         // %/s for speed changes inside a move
+    float brake_rate;        // %/s for brake_to_stop
+    float padding_m;         // slow zone at both ends of a move
+    float padding_speed;     // % duty in the slow zone
+    float brake_distance_m;  // predicted coast after a stop command at padding speed
+
+    // Outcome of the validation simulation
+    float sim_settle_s;
+    float sim_overshoot_pct;
+    float sim_stop_error_m;
+    bool  valid;
+};
+
+// Line paid out after a stop command at the given duty: slew ramp down, then inertia lag
+static inline float tune_brake_distance_pulses(const PlantParams& p, float duty_pct, float brake_rate) {
+    float v = speed_for_duty(p, duty_pct);
+    float ramp_s = (duty_pct > p.deadzone_pct) ? (duty_pct - p.deadzone_pct) / brake_rate : 0.0f;
+    return v * ramp_s * 0.5f + v * p.tau_s;
+}
+
+// Speed step through the closed loop; reports overshoot and 5 % settling time of the true speed
+static inline void tune_sim_step(const PlantParams& p, const TuneResult& r, float ref_pps,
+                                 float horizon_s, float* overshoot_pct, float* settle_s) {
+    const float dt = 0.001f;
+    PlantState s = {0.0f, 0.0f};
+    SpeedLoop loop = {r.speed_kp, r.speed_ki, 0.0f};
+
+    float duty = 0.0f, duty_target = duty_for_speed(p, ref_pps);
+    float loop_t = 0.0f, peak = 0.0f, last_out = 0.0f;
+    uint32_t last_pulses = 0;
+
+    for (float t = 0.0f; t < horizon_s; t += dt) {
+        if (loop_t >= SPEED_LOOP_DT_S) {
+            uint32_t now = (uint32_t)s.pos_pulses;
+            float meas = (float)(now - last_pulses) / loop_t;
+            last_pulses = now;
+            duty_target = speed_loop_update(loop, p, ref_pps, meas, loop_t);
+            loop_t = 0.0f;
+        }
+
+        duty = slew_step(duty, duty_target, r.slew_rate, dt);
+        plant_step(s, p, duty, dt);
+        loop_t += dt;
+
+        if (s.speed_pps > peak) peak = s.speed_pps;
+        if (fabsf(s.speed_pps - ref_pps) > 0.05f * ref_pps) last_out = t + dt;
+    }
+
+    *overshoot_pct = (peak > ref_pps) ? (peak - ref_pps) / ref_pps * 100.0f : 0.0f;
+    *settle_s = last_out;
+}
+
+// Full move through the same reference / speed loop / brake sequence as move_meters
+static inline bool tune_sim_move(const PlantParams& p, const TuneResult& r,
+                                 float meters, float cruise_pct, float* stop_error_m) {
+    const float dt = 0.001f;
+    uint32_t target = (uint32_t)(meters * p.pulses_per_meter + 0.5f);
+    uint32_t pad    = (uint32_t)(r.padding_m * p.pulses_per_meter + 0.5f);
+    if (pad * 2 >= target) pad = target / 2;
+
+    float cruise_pps = speed_for_duty(p, cruise_pct);
+    float pad_pps    = speed_for_duty(p, r.padding_speed);
+
+    PlantState s = {0.0f, 0.0f};
+    SpeedLoop loop = {r.speed_kp, r.speed_ki, 0.0f};
+    float duty = 0.0f, duty_target = duty_for_speed(p, pad_pps);
+    float loop_t = 0.0f, t = 0.0f;
+    uint32_t last_pulses = 0;
+
+    while ((uint32_t)s.pos_pulses < target) {
+        if (t > 60.0f) return false; // same as the firmware move timeout
+
+        if (loop_t >= SPEED_LOOP_DT_S) {
+            uint32_t now = (uint32_t)s.pos_pulses;
+            float meas = (float)(now - last_pulses) / loop_t;
+            last_pulses = now;
+            float ref = move_speed_ref_pps(now, target, pad, cruise_pps, pad_pps, r.pos_kp);
+            duty_target = speed_loop_update(loop, p, ref, meas, loop_t);
+            loop_t = 0.0f;
+        }
+
+        duty = slew_step(duty, duty_target, r.slew_rate, dt);
+        plant_step(s, p, duty, dt);
+        loop_t += dt;
+        t += dt;
+    }
+
+    // brake_to_stop, then let the drum coast out
+    for (float tb = 0.0f; tb < 5.0f && (duty > 0.0f || s.speed_pps > 0.5f); tb += dt) {
+        duty = slew_step(duty, 0.0f, r.brake_rate, dt);
+        plant_step(s, p, duty, dt);
+    }
+
+    *stop_error_m = (s.pos_pulses - (float)target) / p.pulses_per_meter;
+    return true;
+}
+
+// Slowest speed-loop wn that pole placement can reach at damping zeta: below 2 zeta wn tau = 1
+// it would need kp < 0, i.e. the plant alone (on the model feedforward) is already faster than
+// asked for
+static inline float tune_wn_floor(const PlantParams& p, float zeta) {
+    return 1.0f / (2.0f * zeta * p.tau_s);
+}
+
+static inline TuneResult tune_gains(const PlantParams& p, const TuneSpec& spec,
+                                    float zeta, float wn, float padding_speed) {
+    TuneResult r = {};
+    const float K = p.gain_pps_per_pct;
+
+    // Closed loop of PI + first-order plant: s^2 + (1 + K kp)/tau s + K ki/tau.
+    // Below the floor the placement can't be met; the loop is then an integral trim on the
+    // feedforward (kp = 0, ki for wn), which the validation below accepts or rejects like any
+    // other candidate and autotune_run reports.
+    r.speed_kp = (wn >= tune_wn_floor(p, zeta)) ? (2.0f * zeta * wn * p.tau_s - 1.0f) / K : 0.0f;
+    r.speed_ki = wn * wn * p.tau_s / K;
+
+    // Outer position loop kept well inside the speed-loop bandwidth
+    r.pos_kp = wn / 3.0f;
+
+    // Let the duty ramp to cruise within half the settle time
+    r.slew_rate = spec.cruise_pct / (0.5f * spec.settle_s);
+    if (r.slew_rate < 50.0f)   r.slew_rate = 50.0f;
+    if (r.slew_rate > 2000.0f) r.slew_rate = 2000.0f;
+    r.brake_rate = 2.0f * r.slew_rate;
+
+    r.padding_speed = padding_speed;
+
+    // Slow zone = decel from cruise + the position-loop ramp, with 20 % margin
+    float v_c = speed_for_duty(p, spec.cruise_pct);
+    float v_p = speed_for_duty(p, padding_speed);
+    float decel_s = (spec.cruise_pct - padding_speed) / r.slew_rate + p.tau_s;
+    float pad_pulses = 0.5f * (v_c + v_p) * decel_s + v_p / r.pos_kp;
+    r.padding_m = 1.2f * pad_pulses / p.pulses_per_meter;
+
+    // No longer than the validation move exercises (move_pad_pulses stops it at half the move),
+    // so a detuned, slow position loop can't make every move crawl on an untested padding
+    if (r.padding_m > 0.5f * spec.test_move_m) r.padding_m = 0.5f * spec.test_move_m;
+
+    r.brake_distance_m = tune_brake_distance_pulses(p, padding_speed, r.brake_rate) / p.pulses_per_meter;
+    return r;
+}
+
+// Compute, simulate and (if needed) detune until the candidate meets the spec.
+// Returns valid = false if no candidate passed; the caller keeps its current settings then.
+static inline TuneResult autotune_compute(const PlantParams& p, const TuneSpec& spec) {
+    float os = spec.overshoot_pct / 100.0f;
+    if (os < 1e-4f) os = 1e-4f;
+    if (os > 0.9f)  os = 0.9f;
+
+    float lnos = logf(os);
+    float zeta = -lnos / sqrtf((float)(M_PI * M_PI) + lnos * lnos);
+    float wn   = 3.0f / (zeta * spec.settle_s);
+
+    // Fastest padding speed whose stop (from the creep floor) stays inside the tolerance
+    const float brake_rate_guess = 2.0f * spec.cruise_pct / (0.5f * spec.settle_s);
+    float padding_speed = spec.cruise_pct;
+    while (padding_speed > p.deadzone_pct + 5.0f) {
+        float creep_duty = duty_for_speed(p, 0.25f * speed_for_duty(p, padding_speed));
+        float d = tune_brake_distance_pulses(p, creep_duty, brake_rate_guess) / p.pulses_per_meter;
+        if (d <= spec.stop_tol_m) break;
+        padding_speed -= 1.0f;
+    }
+
+    TuneResult r = {};
+    for (int iter = 0; iter < 12; iter++) {
+        r = tune_gains(p, spec, zeta, wn, padding_speed);
+
+        tune_sim_step(p, r, speed_for_duty(p, 0.5f * spec.cruise_pct), 4.0f * spec.settle_s + 1.0f,
+                      &r.sim_overshoot_pct, &r.sim_settle_s);
+
+        bool moved = tune_sim_move(p, r, spec.test_move_m, spec.cruise_pct, &r.sim_stop_error_m);
+
+        bool speed_ok = r.sim_overshoot_pct <= spec.overshoot_pct + 2.0f &&
+                        r.sim_settle_s <= 1.25f * spec.settle_s;
+        bool stop_ok  = moved && fabsf(r.sim_stop_error_m) <= spec.stop_tol_m;
+
+        if (speed_ok && stop_ok) {
+            r.valid = true;
+            return r;
+        }
+
+        // Detune whichever part failed
+        if (!speed_ok) wn *= 0.8f;
+        if (!stop_ok && padding_speed > p.deadzone_pct + 2.0f) padding_speed *= 0.85f;
+    }
+
+    r.valid = false;
+    return r;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+// Line-based command link over USB stdio: "<cmd> [args...]\n", space separated.
+// Line assembly and tokenising only; dispatch lives with the firmware. No hardware access here.
+
+#include <stdint.h>
+#include <stdlib.h>
+
+static constexpr int CMD_LINE_MAX = 96;
+static constexpr int CMD_ARGS_MAX = 8;
+
+struct LineBuffer {
+    char    buf[CMD_LINE_MAX];
+    uint8_t len;
+    bool    overflow;   // current line was too long; drop it at the newline
+};
+
+// Feed one received character. Returns true when buf holds a complete, NUL-terminated line.
+static inline bool line_feed(LineBuffer& lb, int c) {
+    if (c == '\r' || c == '\n') {
+        bool ready = !lb.overflow && lb.len > 0;
+        lb.buf[ready ? lb.len : 0] = '\0';
+        lb.len = 0;
+        lb.overflow = false;
+        return ready;
+    }
+
+    if (c < 0x20 || c > 0x7E) return false;  // ignore non-printables
+
+    if (lb.len + 1 >= CMD_LINE_MAX) {
+        lb.overflow = true;
+        return false;
+    }
+
+    lb.buf[lb.len++] = (char)c;
+    return false;
+}
+
+// Split in place on spaces. Returns argc; extra tokens beyond max_args are dropped.
+static inline int split_args(char* line, char** argv, int max_args) {
+    int argc = 0;
+    char* p = line;
+
+    while (*p && argc < max_args) {
+        while (*p == ' ') p++;
+        if (!*p) break;
+
+        argv[argc++] = p;
+        while (*p && *p != ' ') p++;
+        if (*p) *p++ = '\0';
+    }
+    return argc;
+}
+
+// Whole-token number within [lo, hi]. Rejects empty tokens, trailing junk, NaN and anything
+// out of range, so a garbled line can't reach a float-to-int conversion or a motion command.
+static inline bool arg_float(const char* s, float lo, float hi, float* out) {
+    char* end;
+    float v = strtof(s, &end);
+    if (end == s || *end != '\0' || !(v >= lo && v <= hi)) return false;
+    *out = v;
+    return true;
+}
+
+static inline bool arg_u32(const char* s, uint32_t lo, uint32_t hi, uint32_t* out) {
+    if (*s < '0' || *s > '9') return false;   // strtoul would accept a sign
+
+    char* end;
+    unsigned long v = strtoul(s, &end, 10);
+    if (*end != '\0' || v < lo || v > hi) return false;
+    *out = (uint32_t)v;
+    return true;
+}
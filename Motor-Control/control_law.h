@@ -0,0 +1,126 @@
+#pragma once
+
+// Control-law pieces shared by the firmware loops and the internal tuning simulation.
+// Nothing here touches hardware or a clock; callers pass dt in.
+
+#include <math.h>
+#include <stdint.h>
+#include "winch_model.h"
+
+// Closed-loop speed control runs on FG pulse deltas over this period
+static constexpr float SPEED_LOOP_DT_S = 0.02f;
+
+// Slew target as the limiter accepts it: 0..100 %, NaN -> 0
+static inline float slew_clamp_target(float target_pct) {
+    if (!(target_pct > 0.0f)) return 0.0f;
+    if (target_pct > 100.0f)  return 100.0f;
+    return target_pct;
+}
+
+// A rate that is not positive (or NaN) would freeze the duty; crawl at 1 %/s instead
+static inline float slew_clamp_rate(float rate_percent_per_sec) {
+    return (rate_percent_per_sec > 0.0f) ? rate_percent_per_sec : 1.0f;
+}
+
+// One step of the duty slew limiter: move current toward target by at most rate * dt.
+// Never overshoots target and lands on it exactly; dt <= 0 (or a NaN step) leaves current as is.
+static inline float slew_step(float current, float target, float rate_percent_per_sec, float dt_s) {
+    float max_step = rate_percent_per_sec * dt_s;
+    float error = target - current;
+
+    if (!(max_step > 0.0f)) return current;
+
+    if (fabsf(error) <= max_step) return target;
+    return current + (error > 0 ? max_step : -max_step);
+}
+
+// Duty that holds a given speed in steady state (inverse of the plant gain)
+static inline float duty_for_speed(const PlantParams& p, float pps) {
+    if (pps <= 0) return 0.0f;
+    return p.deadzone_pct + pps / p.gain_pps_per_pct;
+}
+
+static inline float speed_for_duty(const PlantParams& p, float duty_pct) {
+    float eff = duty_pct - p.deadzone_pct;
+    return (eff > 0) ? p.gain_pps_per_pct * eff : 0.0f;
+}
+
+// Pulses a turning drum makes at least in one stall window at this commanded duty (the fixed
+// bands, without a plant model); 0 = too slow to tell a stall from a crawl
+static inline uint32_t stall_min_pulses(float cmd_pct) {
+    if (cmd_pct < 15.0f) return 0;
+    if (cmd_pct < 40.0f) return 1;
+    if (cmd_pct < 70.0f) return 2;
+    return 3;
+}
+
+// With the plant model: a quarter of the speed it predicts at this duty (so a slow but turning
+// drum isn't flagged), which spurious edges at a jammed drum don't reach; 0 = too close to the
+// deadzone to tell
+static inline uint32_t stall_min_pulses_model(const PlantParams& p, float duty_pct, float window_s) {
+    return (uint32_t)(0.25f * speed_for_duty(p, duty_pct - 5.0f) * window_s);
+}
+
+// FG pulses for a distance, rounded to nearest. Rejects NaN, negative distances and anything
+// over max_m (the line the drum holds), so a move can't quietly run short; 0 m is 0 pulses.
+static inline bool pulses_for_meters(float meters, float pulses_per_meter, float max_m, uint32_t* out) {
+    if (!(meters >= 0.0f && meters <= max_m)) return false;
+    *out = (uint32_t)(meters * pulses_per_meter + 0.5f);
+    return true;
+}
+
+// Slow-down padding for a move: a move too short for padding at both ends goes slow all the way
+// (pad = target / 2), so start and end padding never overlap
+static inline uint32_t move_pad_pulses(uint32_t target, uint32_t pad_pulses) {
+    if ((uint64_t)pad_pulses * 2 >= target) pad_pulses = target / 2;
+    return pad_pulses;
+}
+
+// Open-loop move profile: padding_speed over the first and last pad_pulses, cruise in between
+static inline float move_duty_open_loop(uint32_t now, uint32_t target, uint32_t pad_pulses,
+                                        float cruise_pct, float padding_pct) {
+    uint32_t remaining = (now < target) ? (target - now) : 0;
+
+    if (now < pad_pulses)       return padding_pct;
+    if (remaining < pad_pulses) return padding_pct;
+    return cruise_pct;
+}
+
+struct SpeedLoop {
+    float kp;     // % duty per pulse/s of speed error
+    float ki;     // % duty per pulse of integrated speed error
+    float integ;  // integrated error (pulses)
+};
+
+// PI on speed around the model feedforward, plus any load feedforward (e.g. gravity) in %.
+// The integrator only accumulates while the output is unsaturated (anti-windup).
+static inline float speed_loop_update(SpeedLoop& s, const PlantParams& p,
+                                      float ref_pps, float meas_pps, float dt_s,
+                                      float load_ff_pct = 0.0f) {
+    float err = ref_pps - meas_pps;
+    float ff  = duty_for_speed(p, ref_pps) + load_ff_pct;
+    float out = ff + s.kp * err + s.ki * (s.integ + err * dt_s);
+
+    if (out > 0.0f && out < 100.0f) s.integ += err * dt_s;
+
+    if (out < 0.0f)   out = 0.0f;
+    if (out > 100.0f) out = 100.0f;
+    return out;
+}
+
+// Speed reference for a closed-loop move: start gently, cruise, then let the
+// position loop bring the reference down over the last pad_pulses.
+static inline float move_speed_ref_pps(uint32_t now, uint32_t target, uint32_t pad_pulses,
+                                       float cruise_pps, float pad_pps, float pos_kp) {
+    uint32_t remaining = (now < target) ? (target - now) : 0;
+
+    if (now < pad_pulses) return pad_pps;
+    if (remaining >= pad_pulses) return cruise_pps;
+
+    // creep floor keeps the drum moving through the deadzone until the target is reached
+    float creep = pad_pps * 0.25f;
+    float ref = pos_kp * (float)remaining;
+    if (ref > pad_pps) ref = pad_pps;
+    if (ref < creep)   ref = creep;
+    return ref;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+// Energy-optimal move profiles.
+// Electrical model of the drive built from the variant (supply, winding resistance, gearing)
+// and the identified plant (gain -> back-EMF constant, tau -> inertia, deadzone -> friction):
+//   I = (T_gravity + T_friction + J * alpha) / Ke,   P = I^2 R + Ke * omega * I
+// Energy is integrated over trapezoidal speed profiles (time T, accel fraction f); the search
+// picks the pair with the least supply energy that fits the time budget and the duty limit.
+// Gravity work is the same for every profile; what changes is I^2 R (accelerations, and
+// holding the load longer) and friction, so the best profile is usually slower than the
+// fastest but not the slowest. Negative power (lowering) is burnt in the bridge, not recovered.
+// No hardware access here.
+
+#include <math.h>
+#include <stdint.h>
+#include "winch_variants.h"
+#include "winch_model.h"
+
+struct MotorElec {
+    float supply_v;
+    float r_ohm;
+    float ke;             // V per motor rad/s (= Nm per A)
+    float j_kgm2;         // at the motor shaft, from the identified tau
+    float friction_nm;    // at the motor shaft, from the identified deadzone
+    float rad_per_m;      // motor rad per metre of line
+    float drum_r_m;
+    float gear_ratio;
+    float max_duty;       // %
+};
+
+static inline MotorElec motor_elec_from(const WinchDerived& w, const PlantParams& p) {
+    MotorElec m;
+    m.supply_v   = w.v->supply_v;
+    m.r_ohm      = w.v->winding_ohm;
+    m.drum_r_m   = 0.5f * w.v->drum_diameter_m;
+    m.gear_ratio = w.v->gear_ratio;
+    m.max_duty   = w.v->max_duty_pct;
+
+    // motor rad per FG pulse, and per metre of line
+    float rad_per_pulse = 2.0f * (float)M_PI / (float)w.v->fg_pulses_per_motor_rev;
+    m.rad_per_m = p.pulses_per_meter * rad_per_pulse;
+
+    // no-load speed extrapolated to 100 % duty without the deadzone
+    float omega_nl = p.gain_pps_per_pct * 100.0f * rad_per_pulse;
+    m.ke = m.supply_v / omega_nl;
+
+    // tau = J R / Ke^2, and the deadzone duty is what overcomes friction at standstill
+    m.j_kgm2 = p.tau_s * m.ke * m.ke / m.r_ohm;
+    m.friction_nm = m.ke * (p.deadzone_pct * 0.01f * m.supply_v) / m.r_ohm;
+    return m;
+}
+
+// Duty that balances the payload's weight at standstill: + when lifting, - when lowering
+static inline float gravity_duty_pct(const MotorElec& e, float payload_kg, bool lifting) {
+    float torque = payload_kg * 9.81f * e.drum_r_m / e.gear_ratio;
+    float pct = 100.0f * (torque / e.ke) * e.r_ohm / e.supply_v;
+    return lifting ? pct : -pct;
+}
+
+struct MoveProfile {
+    float time_s;         // 0 = infeasible
+    float accel_frac;     // of time_s, each end
+    float v_peak_mps;
+    float energy_j;       // predicted supply energy
+    float peak_duty;
+};
+
+// Trapezoid position / speed at time t (rest to rest)
+static inline void profile_at(const MoveProfile& m, float dist_m, float t, float* pos_m, float* v_mps) {
+    float T = m.time_s, ta = m.accel_frac * T, v = m.v_peak_mps;
+    float a = (ta > 0.0f) ? v / ta : 0.0f;
+
+    if (t <= 0.0f)        { *pos_m = 0.0f; *v_mps = 0.0f; }
+    else if (t < ta)      { *pos_m = 0.5f * a * t * t; *v_mps = a * t; }
+    else if (t < T - ta)  { *pos_m = 0.5f * a * ta * ta + v * (t - ta); *v_mps = v; }
+    else if (t < T)       { float r = T - t; *pos_m = dist_m - 0.5f * a * r * r; *v_mps = a * r; }
+    else                  { *pos_m = dist_m; *v_mps = 0.0f; }
+}
+
+// Supply energy of one profile, and its peak duty. lifting = winding in against gravity.
+static inline float profile_energy_j(const MotorElec& e, float payload_kg, bool lifting,
+                                     float dist_m, MoveProfile& m) {
+    const uint32_t N = 100;
+    float dt = m.time_s / (float)N;
+    float t_grav = payload_kg * 9.81f * e.drum_r_m / e.gear_ratio * (lifting ? 1.0f : -1.0f);
+    float ta = m.accel_frac * m.time_s;
+    float a = (ta > 0.0f) ? m.v_peak_mps / ta : 0.0f;
+
+    float energy = 0.0f, peak = 0.0f;
+    for (uint32_t i = 0; i < N; i++) {
+        float t = ((float)i + 0.5f) * dt, pos, v;
+        profile_at(m, dist_m, t, &pos, &v);
+
+        float acc = (t < ta) ? a : (t > m.time_s - ta ? -a : 0.0f);
+        float omega = v * e.rad_per_m;
+        float torque = t_grav + e.friction_nm + e.j_kgm2 * acc * e.rad_per_m;
+        float amps = torque / e.ke;
+        float volts = amps * e.r_ohm + e.ke * omega;
+
+        float p = volts * amps;
+        if (p > 0.0f) energy += p * dt;
+
+        float duty = 100.0f * volts / e.supply_v;
+        if (duty > peak) peak = duty;
+    }
+    m.peak_duty = peak;
+    m.energy_j = energy;
+    return energy;
+}
+
+static inline MoveProfile profile_trapezoid(float dist_m, float time_s, float accel_frac) {
+    MoveProfile m;
+    m.time_s = time_s;
+    m.accel_frac = accel_frac;
+    m.v_peak_mps = dist_m / (time_s * (1.0f - accel_frac));
+    m.energy_j = 0.0f;
+    m.peak_duty = 0.0f;
+    return m;
+}
+
+// Least-energy profile finishing within time_budget_s (0 = no budget: up to 4x the fastest).
+// v_max and a_max are the line speed and acceleration the drive may use.
+static inline MoveProfile energy_optimal_profile(const MotorElec& e, float payload_kg, bool lifting,
+                                                 float dist_m, float time_budget_s,
+                                                 float v_max, float a_max) {
+    static const float FRACS[] = {0.1f, 0.2f, 0.3333f, 0.4f, 0.5f};
+    MoveProfile best = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    if (!(dist_m > 0.0f) || !(v_max > 0.0f) || !(a_max > 0.0f)) return best;
+
+    // fastest trapezoid the limits allow
+    float t_min = (dist_m * a_max > v_max * v_max) ? dist_m / v_max + v_max / a_max
+                                                   : 2.0f * sqrtf(dist_m / a_max);
+    float t_max = (time_budget_s > 0.0f) ? time_budget_s : 4.0f * t_min;
+    if (t_max < t_min) return best;
+
+    const uint32_t STEPS = 16;
+    for (uint32_t i = 0; i <= STEPS; i++) {
+        float T = t_min + (t_max - t_min) * (float)i / (float)STEPS;
+
+        for (float f : FRACS) {
+            MoveProfile m = profile_trapezoid(dist_m, T, f);
+            if (m.v_peak_mps > v_max * 1.001f || m.v_peak_mps / (f * T) > a_max * 1.001f) continue;
+
+            profile_energy_j(e, payload_kg, lifting, dist_m, m);
+            if (m.peak_duty > e.max_duty) continue;
+            if (best.time_s == 0.0f || m.energy_j < best.energy_j) best = m;
+        }
+    }
+    return best;
+}
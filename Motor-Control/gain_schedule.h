@@ -0,0 +1,149 @@
+#pragma once
+
+// Gain schedule over payload mass, line out and speed.
+// One tune fits one operating point; this table re-derives the speed-loop gains, the slew
+// rate and the stall expectation at a grid of points from the identified plant and the
+// electrical model, and the control loop interpolates it (trilinear) every update:
+//  - mass adds reflected inertia (slower plant: higher gains for the same bandwidth), a
+//    gravity torque that shifts the effective deadzone up when lifting and down when lowering,
+//    and limits how fast the duty may ramp before the acceleration current runs out
+//  - a long line stretches and bounces, so the loop bandwidth is lowered with line out
+//  - at low speed FG edges are sparse and the speed measurement coarse, so likewise
+// No hardware access here.
+
+#include <math.h>
+#include <stdint.h>
+#include "winch_model.h"
+#include "control_law.h"
+#include "autotune.h"
+#include "energy_profile.h"
+
+static constexpr uint32_t GS_MASS_N  = 4;
+static constexpr uint32_t GS_LINE_N  = 3;
+static constexpr uint32_t GS_SPEED_N = 3;
+
+struct GainPoint {
+    float speed_kp;
+    float speed_ki;
+    float slew_rate;     // %/s
+    float dz_lift_pct;   // duty where the drum starts turning, winding in under the load
+    float dz_lower_pct;  // same, paying out
+};
+
+struct GainSchedule {
+    float mass_kg[GS_MASS_N];
+    float line_m[GS_LINE_N];
+    float speed_pct[GS_SPEED_N];
+    GainPoint pt[GS_MASS_N][GS_LINE_N][GS_SPEED_N];
+    bool valid;
+};
+
+// Same closed-loop targets as autotune_compute
+static inline void gs_targets(const TuneSpec& spec, float* zeta, float* wn) {
+    float os = spec.overshoot_pct / 100.0f;
+    if (os < 1e-4f) os = 1e-4f;
+    if (os > 0.9f)  os = 0.9f;
+
+    float lnos = logf(os);
+    *zeta = -lnos / sqrtf((float)(M_PI * M_PI) + lnos * lnos);
+    *wn   = 3.0f / (*zeta * spec.settle_s);
+}
+
+static inline void gs_build(GainSchedule& g, const PlantParams& p, const MotorElec& e,
+                            const TuneSpec& spec, float max_line_m) {
+    float zeta, wn;
+    gs_targets(spec, &zeta, &wn);
+
+    const float K = p.gain_pps_per_pct;
+    const float arm = e.drum_r_m / e.gear_ratio;            // line force -> motor torque
+    const float rad_per_pulse = e.rad_per_m / p.pulses_per_meter;
+
+    // heaviest payload that still leaves half the stall torque at the duty cap
+    float t_stall = e.ke * (e.supply_v * e.max_duty * 0.01f) / e.r_ohm;
+    float m_max = 0.5f * t_stall / (9.81f * arm);
+
+    for (uint32_t i = 0; i < GS_MASS_N; i++) g.mass_kg[i] = m_max * (float)i / (float)(GS_MASS_N - 1);
+    for (uint32_t j = 0; j < GS_LINE_N; j++) g.line_m[j] = max_line_m * (float)j / (float)(GS_LINE_N - 1);
+    g.speed_pct[0] = 20.0f;
+    g.speed_pct[1] = 60.0f;
+    g.speed_pct[2] = 100.0f;
+
+    for (uint32_t i = 0; i < GS_MASS_N; i++) {
+        float m = g.mass_kg[i];
+        float j_tot = e.j_kgm2 + m * arm * arm;
+        float tau = p.tau_s * j_tot / e.j_kgm2;
+
+        // gravity torque expressed as duty
+        float grav_pct = gravity_duty_pct(e, m, true);
+
+        // duty ramp the spare torque can accelerate: alpha = (T_avail - T_load) / J
+        float t_avail = t_stall - m * 9.81f * arm - e.friction_nm;
+        float alpha = (t_avail > 0.0f) ? t_avail / j_tot : 0.0f;
+        float slew = alpha / (K * rad_per_pulse);
+        if (slew < 50.0f)   slew = 50.0f;
+        if (slew > 2000.0f) slew = 2000.0f;
+
+        for (uint32_t j = 0; j < GS_LINE_N; j++) {
+            float wn_line = wn / (1.0f + 0.1f * g.line_m[j]);
+
+            for (uint32_t k = 0; k < GS_SPEED_N; k++) {
+                float wn_pt = wn_line * ((g.speed_pct[k] < 50.0f) ? 0.5f + g.speed_pct[k] / 100.0f : 1.0f);
+
+                GainPoint& gp = g.pt[i][j][k];
+                gp.speed_kp = (2.0f * zeta * wn_pt * tau - 1.0f) / K;
+                if (gp.speed_kp < 0.0f) gp.speed_kp = 0.0f;
+                gp.speed_ki = wn_pt * wn_pt * tau / K;
+                gp.slew_rate = slew;
+                gp.dz_lift_pct  = p.deadzone_pct + grav_pct;
+                gp.dz_lower_pct = (p.deadzone_pct > grav_pct) ? p.deadzone_pct - grav_pct : 0.0f;
+            }
+        }
+    }
+    g.valid = true;
+}
+
+// Index and fraction of x on an ascending axis, clamped to its ends
+static inline uint32_t gs_axis(const float* axis, uint32_t n, float x, float* frac) {
+    if (x <= axis[0]) { *frac = 0.0f; return 0; }
+    for (uint32_t i = 0; i + 1 < n; i++) {
+        if (x <= axis[i + 1]) {
+            float span = axis[i + 1] - axis[i];
+            *frac = (span > 0.0f) ? (x - axis[i]) / span : 0.0f;
+            return i;
+        }
+    }
+    *frac = 1.0f;
+    return n - 2;
+}
+
+static inline GainPoint gs_lookup(const GainSchedule& g, float mass_kg, float line_m, float speed_pct) {
+    float fm, fl, fs;
+    uint32_t im = gs_axis(g.mass_kg, GS_MASS_N, mass_kg, &fm);
+    uint32_t il = gs_axis(g.line_m, GS_LINE_N, line_m, &fl);
+    uint32_t is = gs_axis(g.speed_pct, GS_SPEED_N, speed_pct, &fs);
+
+    GainPoint out = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (uint32_t c = 0; c < 8; c++) {
+        uint32_t dm = c & 1, dl = (c >> 1) & 1, ds = (c >> 2) & 1;
+        float w = (dm ? fm : 1.0f - fm) * (dl ? fl : 1.0f - fl) * (ds ? fs : 1.0f - fs);
+        if (w == 0.0f) continue;
+
+        const GainPoint& q = g.pt[im + dm][il + dl][is + ds];
+        out.speed_kp     += w * q.speed_kp;
+        out.speed_ki     += w * q.speed_ki;
+        out.slew_rate    += w * q.slew_rate;
+        out.dz_lift_pct  += w * q.dz_lift_pct;
+        out.dz_lower_pct += w * q.dz_lower_pct;
+    }
+    return out;
+}
+
+// Pulses a healthy drum makes in the stall window at this duty (a quarter of the model's
+// speed, so a slow but turning drum isn't flagged); 0 = too close to the deadzone to tell.
+static inline uint32_t gs_stall_min_pulses(const GainPoint& gp, const PlantParams& p,
+                                           float duty_pct, bool lifting, float window_s) {
+    float dz = lifting ? gp.dz_lift_pct : gp.dz_lower_pct;
+    float pps = p.gain_pps_per_pct * (duty_pct - dz - 5.0f);
+    if (pps <= 0.0f) return 0;
+    return (uint32_t)(0.25f * pps * window_s);
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+// Hold-mode correction sizing.
+// A nudge should put back exactly the line that slipped: run for the slip distance minus the
+// coast the drum adds while braking, at a speed matched to how fast it slipped. The coast
+// prediction comes from the plant model and is scaled by what previous nudges actually did.
+// Nudges are rate limited by how long the drum + payload take to settle after one, so the
+// next correction sees the true residual slip instead of the last one's transient.
+// No hardware access here.
+
+#include <math.h>
+#include <stdint.h>
+#include "winch_model.h"
+#include "control_law.h"
+#include "autotune.h"
+
+struct HoldAdapt {
+    float coast_scale;   // measured / predicted coast of past nudges (1 = trust the model)
+};
+
+struct NudgePlan {
+    float    duty_pct;
+    uint32_t run_pulses;        // stop commanded after this many pulses
+    float    coast_pulses;      // expected after the stop command
+};
+
+static inline void hold_adapt_reset(HoldAdapt& a) {
+    a.coast_scale = 1.0f;
+}
+
+// Catch up at twice the slip rate, capped at max_duty
+static inline float nudge_duty_for_slip(const PlantParams& p, float slip_pps, float max_duty) {
+    float duty = duty_for_speed(p, 2.0f * slip_pps);
+    float floor = p.deadzone_pct + 5.0f;
+
+    if (duty < floor) duty = floor;
+    if (duty > max_duty) duty = max_duty;
+    return duty;
+}
+
+static inline NudgePlan nudge_plan(const PlantParams& p, const HoldAdapt& a, uint32_t slip_pulses,
+                                   float slip_pps, float max_duty, float brake_rate,
+                                   uint32_t max_pulses) {
+    NudgePlan n;
+    n.duty_pct = nudge_duty_for_slip(p, slip_pps, max_duty);
+    n.coast_pulses = a.coast_scale * tune_brake_distance_pulses(p, n.duty_pct, brake_rate);
+
+    // Small slips: slow down until the coast alone doesn't overshoot them
+    float floor = p.deadzone_pct + 5.0f;
+    while (n.coast_pulses > 0.5f * (float)slip_pulses && n.duty_pct > floor) {
+        n.duty_pct -= 1.0f;
+        if (n.duty_pct < floor) n.duty_pct = floor;
+        n.coast_pulses = a.coast_scale * tune_brake_distance_pulses(p, n.duty_pct, brake_rate);
+    }
+
+    float run = (float)slip_pulses - n.coast_pulses;
+    n.run_pulses = (run > 1.0f) ? (uint32_t)(run + 0.5f) : 1;
+    if (n.run_pulses > max_pulses) n.run_pulses = max_pulses;
+    return n;
+}
+
+// Learn from one nudge: total_pulses seen from start to standstill
+static inline void hold_adapt_update(HoldAdapt& a, const NudgePlan& n, uint32_t total_pulses) {
+    if (n.coast_pulses < 1.0f || total_pulses < n.run_pulses) return;
+
+    float measured = (float)(total_pulses - n.run_pulses);
+    float ratio = a.coast_scale * measured / n.coast_pulses;
+    if (ratio < 0.25f) ratio = 0.25f;
+    if (ratio > 4.0f)  ratio = 4.0f;
+
+    a.coast_scale += 0.5f * (ratio - a.coast_scale);
+}
+
+// Earliest next nudge after one ends: the drum's lag plus any bounce the shaper is waiting out
+static inline float hold_settle_s(const PlantParams& p, float shaper_s) {
+    return 3.0f * p.tau_s + shaper_s;
+}
+
+// ---- Which way did it move? ----
+// FG has no direction, so uncommanded motion during a hold is classified from circumstantial
+// evidence, each term adding to the log-odds that the payload went down:
+//  - a loaded line is pulled down by gravity
+//  - holding duty (toward up) above what balances the load pushes it up; a friction's worth
+//    above it is enough to be winning and outweighs the loaded line
+//  - edges right after a commanded motion are its coast, in that direction (decays with settle time)
+//  - speeding up means a sustained force (gravity); slowing down means a bump running out
+// Confidence is 0 for a coin toss and approaches 1 when the evidence agrees.
+
+struct SlipEvidence {
+    bool  loaded;            // payload on the line
+    float hold_duty_pct;     // duty applied toward up while holding
+    float balance_duty_pct;  // duty that just balances the load (0 if unknown)
+    float friction_duty_pct; // duty the drive must beat the load by to turn the drum (0 if unknown)
+    bool  last_cmd_up;       // direction of the last commanded motion
+    float since_cmd_s;       // time since that motion stopped
+    float settle_s;          // hold_settle_s()
+    float rate_trend;        // (older - newer edge interval) / older: > 0 speeding up
+};
+
+struct SlipDirection {
+    bool  down;
+    float confidence;
+};
+
+static inline SlipDirection slip_direction(const SlipEvidence& e) {
+    float score = 0.0f;
+
+    if (e.loaded) score += 1.5f;
+
+    float excess = e.hold_duty_pct - e.balance_duty_pct;
+    if (e.hold_duty_pct > 0.0f)
+        score -= (e.friction_duty_pct > 0.0f ? 3.0f / e.friction_duty_pct : 0.2f) * excess;
+
+    if (e.settle_s > 0.0f) {
+        float coast = 3.0f * expf(-e.since_cmd_s / e.settle_s);
+        score += e.last_cmd_up ? -coast : coast;
+    }
+
+    float trend = e.rate_trend;
+    if (trend >  1.0f) trend =  1.0f;
+    if (trend < -1.0f) trend = -1.0f;
+    score += (e.loaded ? 2.0f : 0.5f) * trend;
+
+    float p_down = 1.0f / (1.0f + expf(-score));
+    SlipDirection d;
+    d.down = p_down >= 0.5f;
+    d.confidence = fabsf(2.0f * p_down - 1.0f);
+    return d;
+}
+
+// ---- Holding torque ----
+// Instead of 0 % duty plus nudges, hold with the duty (toward up) that balances the load.
+// The starting point is payload mass x calibration (or the balance found by the last hold); a
+// PI on the position error then trims it until the drum stops creeping. The integrator alone
+// would be a second integration on top of the drum's (duty -> speed -> position) and swing
+// forever; the proportional term damps it: s^2 + K kp s + K ki, critically damped at
+// kp = 2 sqrt(ki / K).
+// Duty below the deadzone still makes torque, it just doesn't turn an unloaded drum.
+
+struct HoldTorque {
+    float   ff_duty;      // from the payload mass, 0 if unknown
+    float   balance;      // integrator: the duty that holds the load
+    float   duty;         // currently applied: balance + kp * err
+    int32_t err_pulses;   // net line paid out since the hold started (+ = payload went down)
+};
+
+static inline void hold_torque_start(HoldTorque& h, float ff_duty, float learned_duty) {
+    h.ff_duty = ff_duty;
+    h.balance = (ff_duty > 0.0f) ? ff_duty : (learned_duty > 0.0f ? learned_duty : 0.0f);
+    h.duty = h.balance;
+    h.err_pulses = 0;
+}
+
+// One step every dt_s with the pulses seen since the last one and their inferred direction
+static inline float hold_torque_step(HoldTorque& h, uint32_t pulses, bool down,
+                                     float kp, float ki, float dt_s, float max_duty) {
+    h.err_pulses += down ? (int32_t)pulses : -(int32_t)pulses;
+
+    h.balance += ki * (float)h.err_pulses * dt_s;
+    if (h.balance < 0.0f)     h.balance = 0.0f;
+    if (h.balance > max_duty) h.balance = max_duty;
+
+    h.duty = h.balance + kp * (float)h.err_pulses;
+    if (h.duty < 0.0f)     h.duty = 0.0f;
+    if (h.duty > max_duty) h.duty = max_duty;
+    return h.duty;
+}
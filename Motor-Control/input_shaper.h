@@ -0,0 +1,124 @@
+#pragma once
+
+// Zero-vibration input shaping of the duty/speed reference.
+// The reference is convolved with 2 (ZV) or 3 (ZVD) impulses spaced half a damped period
+// apart, so the payload's bounce mode is not excited by speed steps or stops.
+// Runs on fixed-rate samples; no hardware access here.
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+enum ShaperMode : uint32_t {
+    SHAPER_OFF = 0,
+    SHAPER_ZV  = 1,
+    SHAPER_ZVD = 2,
+};
+
+static constexpr float    SHAPER_DT_S = 0.01f;
+static constexpr uint32_t SHAPER_HIST = 256;   // 2.56 s of history: ZVD down to ~0.4 Hz
+
+struct InputShaper {
+    float    hist[SHAPER_HIST];
+    uint32_t head;            // index of the newest sample
+    uint32_t n;               // impulses in use (0 = pass-through)
+    float    amp[3];
+    uint32_t delay[3];        // in samples
+};
+
+// Fill the history with the current reference so (re)enabling causes no jump
+static inline void shaper_reset(InputShaper& s, float value) {
+    for (uint32_t i = 0; i < SHAPER_HIST; i++) s.hist[i] = value;
+    s.head = 0;
+}
+
+// Impulses for the mode at f_hz with damping ratio zeta. Modes too slow for the history
+// buffer fall back to pass-through (returns false).
+static inline bool shaper_design(InputShaper& s, uint32_t mode, float f_hz, float zeta) {
+    s.n = 0;
+    if (mode == SHAPER_OFF || !(f_hz > 0.0f)) return mode == SHAPER_OFF;
+    if (zeta < 0.0f)  zeta = 0.0f;
+    if (zeta > 0.9f)  zeta = 0.9f;
+
+    float wd = 2.0f * (float)M_PI * f_hz * sqrtf(1.0f - zeta * zeta);
+    float half_period = (float)M_PI / wd;
+    float K = expf(-zeta * (float)M_PI / sqrtf(1.0f - zeta * zeta));
+
+    uint32_t d = (uint32_t)(half_period / SHAPER_DT_S + 0.5f);
+    if (d == 0 || (mode == SHAPER_ZVD ? 2 * d : d) >= SHAPER_HIST) return false;
+
+    if (mode == SHAPER_ZV) {
+        s.amp[0] = 1.0f / (1.0f + K);
+        s.amp[1] = K / (1.0f + K);
+        s.delay[0] = 0;
+        s.delay[1] = d;
+        s.n = 2;
+    } else {
+        float den = (1.0f + K) * (1.0f + K);
+        s.amp[0] = 1.0f / den;
+        s.amp[1] = 2.0f * K / den;
+        s.amp[2] = K * K / den;
+        s.delay[0] = 0;
+        s.delay[1] = d;
+        s.delay[2] = 2 * d;
+        s.n = 3;
+    }
+    return true;
+}
+
+// Time the shaped output lags the reference by, i.e. how long a stop takes to finish
+static inline float shaper_duration_s(const InputShaper& s) {
+    return (s.n > 0) ? (float)s.delay[s.n - 1] * SHAPER_DT_S : 0.0f;
+}
+
+// Push one sample (every SHAPER_DT_S) and return the shaped value
+static inline float shaper_step(InputShaper& s, float in) {
+    s.head = (s.head + 1) % SHAPER_HIST;
+    s.hist[s.head] = in;
+
+    if (s.n == 0) return in;
+
+    float out = 0.0f;
+    for (uint32_t i = 0; i < s.n; i++) {
+        out += s.amp[i] * s.hist[(s.head + SHAPER_HIST - s.delay[i]) % SHAPER_HIST];
+    }
+    return out;
+}
+
+// Bounce frequency from FG pulse counts binned at bin_s after a stop.
+// FG has no direction, so a drum rocking at f gives a pulse-rate ripple at 2f; the first
+// autocorrelation peak of the rate is therefore half the mode period. Returns 0 if none.
+static inline float ripple_mode_hz(const uint16_t* bins, uint32_t n, float bin_s) {
+    if (n < 8) return 0.0f;
+
+    float mean = 0.0f;
+    for (uint32_t i = 0; i < n; i++) mean += bins[i];
+    mean /= (float)n;
+
+    auto acf = [&](uint32_t k) {
+        float r = 0.0f;
+        for (uint32_t i = 0; i + k < n; i++) r += (bins[i] - mean) * (bins[i + k] - mean);
+        return r;
+    };
+
+    float r0 = acf(0);
+    if (r0 <= 0.0f) return 0.0f;
+
+    // first local max after the autocorrelation has gone negative
+    bool went_negative = false;
+    for (uint32_t k = 1; k + 1 < n / 2; k++) {
+        float r = acf(k);
+        if (r < 0.0f) went_negative = true;
+        if (!went_negative) continue;
+
+        float rm = acf(k - 1), rp = acf(k + 1);
+        if (r > rm && r >= rp && r > 0.2f * r0) {
+            // parabolic interpolation of the peak
+            float den = rm - 2.0f * r + rp;
+            float frac = (den != 0.0f) ? 0.5f * (rm - rp) / den : 0.0f;
+            float ripple_period = ((float)k + frac) * bin_s;
+            return 0.5f / ripple_period;
+        }
+    }
+    return 0.0f;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+// Line wear map: how often each 10 cm of line went over the drum under load, split into
+// wind and unwind passes. Indexed by distance from the hook (= line-out at the drum contact
+// point), updated from the same FG edge batches as the maintenance counters, whose line-out it
+// follows. This is the only per-segment pass count.
+// No hardware access here.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static constexpr float    WEAR_SEG_M     = 0.1f;
+static constexpr uint32_t WEAR_SEG_COUNT = 256;   // 25.6 m, longest drum in winch_variants.h
+
+struct LineWearMap {
+    uint16_t wound[WEAR_SEG_COUNT];     // passes while winding in (saturating)
+    uint16_t unwound[WEAR_SEG_COUNT];   // passes while paying out (saturating)
+};
+
+// Segments of length seg_m whose midpoint (k + 0.5) * seg_m lies in (lo_m, hi_m].
+// A segment counts one pass over the drum each time the contact point crosses its midpoint.
+static inline void line_segments_crossed(float lo_m, float hi_m, float seg_m,
+                                         int32_t* first, int32_t* last) {
+    *first = (int32_t)floorf(lo_m / seg_m - 0.5f) + 1;
+    *last  = (int32_t)floorf(hi_m / seg_m - 0.5f);
+}
+
+static inline void wear_reset(LineWearMap& w) {
+    memset(&w, 0, sizeof(w));
+}
+
+static inline uint32_t wear_passes(const LineWearMap& w, uint32_t seg) {
+    return (uint32_t)w.wound[seg] + w.unwound[seg];
+}
+
+// Account the line moving from from_pulses to to_pulses (line-out).
+// Returns the first segment that crossed alert_passes in this batch, or -1.
+static inline int32_t wear_account(LineWearMap& w, int32_t from_pulses, int32_t to_pulses,
+                                   float pulses_per_meter, uint32_t alert_passes) {
+    if (from_pulses == to_pulses) return -1;
+
+    bool paying_out = to_pulses > from_pulses;
+    float lo_m = (float)(paying_out ? from_pulses : to_pulses) / pulses_per_meter;
+    float hi_m = (float)(paying_out ? to_pulses : from_pulses) / pulses_per_meter;
+
+    int32_t first, last;
+    line_segments_crossed(lo_m, hi_m, WEAR_SEG_M, &first, &last);
+    if (first < 0) first = 0;
+
+    int32_t alert = -1;
+    for (int32_t k = first; k <= last && k < (int32_t)WEAR_SEG_COUNT; k++) {
+        uint16_t& n = paying_out ? w.unwound[k] : w.wound[k];
+        if (n < 0xFFFF) n++;
+
+        if (alert < 0 && alert_passes > 0 && wear_passes(w, (uint32_t)k) == alert_passes) alert = k;
+    }
+    return alert;
+}
+
+static inline void wear_print_alert(const LineWearMap& w, int32_t seg) {
+    printf("[WEAR] ALERT seg=%ld from_m=%.1f passes=%lu (wound=%u unwound=%u) - inspect/replace line\n",
+           (long)seg, (double)(seg * WEAR_SEG_M), (unsigned long)wear_passes(w, (uint32_t)seg),
+           (unsigned)w.wound[seg], (unsigned)w.unwound[seg]);
+}
+
+// Used segments only, plus the worst one
+static inline void wear_print(const LineWearMap& w, uint32_t alert_passes) {
+    uint32_t worst = 0, worst_n = 0;
+
+    for (uint32_t k = 0; k < WEAR_SEG_COUNT; k++) {
+        uint32_t n = wear_passes(w, k);
+        if (n == 0) continue;
+        if (n > worst_n) { worst = k; worst_n = n; }
+
+        printf("[WEAR] seg=%lu from_m=%.1f wound=%u unwound=%u%s\n",
+               (unsigned long)k, (double)(k * WEAR_SEG_M), (unsigned)w.wound[k], (unsigned)w.unwound[k],
+               (alert_passes > 0 && n >= alert_passes) ? " ALERT" : "");
+    }
+
+    printf("[WEAR] worst seg=%lu from_m=%.1f passes=%lu limit=%lu\n",
+           (unsigned long)worst, (double)(worst * WEAR_SEG_M), (unsigned long)worst_n,
+           (unsigned long)alert_passes);
+}
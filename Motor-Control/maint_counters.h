@@ -0,0 +1,58 @@
+#pragma once
+
+// Lifetime usage counters for maintenance planning.
+// Updated in RAM from FG pulse batches (cheap), flushed to flash by the firmware now and then.
+// Passes per line segment are the line wear map (line_wear.h), fed from the line-out kept here.
+// No hardware access here.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+struct MaintCounters {
+    uint64_t fg_pulses;            // all FG pulses ever seen (motor revs = pulses / FG per rev)
+    uint64_t powered_us;           // time with non-zero duty
+    uint64_t duty_us;              // duty-weighted runtime: sum(duty/100 * dt)
+    uint32_t moves;
+    uint32_t stalls;
+    uint32_t timeouts;
+    uint32_t nudges;
+    uint32_t reversals;            // direction changes between motions
+    uint32_t boots;
+    int32_t  line_out_pulses;      // current line out (0 = fully wound at commissioning)
+    float    line_travel_m;        // total line wound + unwound
+};
+
+static inline void maint_reset(MaintCounters& c) {
+    memset(&c, 0, sizeof(c));
+}
+
+// Account one batch of FG pulses moving in one direction, plus the duty applied over dt.
+static inline void maint_account(MaintCounters& c, uint32_t pulses, bool paying_out,
+                                 float duty_pct, uint32_t dt_us, float pulses_per_meter) {
+    if (duty_pct > 0.0f) {
+        c.powered_us += dt_us;
+        c.duty_us    += (uint64_t)(duty_pct * 0.01f * (float)dt_us);
+    }
+
+    if (pulses == 0) return;
+
+    c.fg_pulses += pulses;
+    c.line_travel_m += (float)pulses / pulses_per_meter;
+
+    int32_t from = c.line_out_pulses;
+    int32_t to   = paying_out ? from + (int32_t)pulses : from - (int32_t)pulses;
+    if (to < 0) to = 0;   // can't wind past fully wound; FG has no direction, so clamp
+    c.line_out_pulses = to;
+}
+
+static inline void maint_print(const MaintCounters& c, uint32_t fg_pulses_per_motor_rev,
+                               float pulses_per_meter) {
+    printf("[MAINT] motor_revs=%llu powered_h=%.3f duty_h=%.3f moves=%lu stalls=%lu timeouts=%lu\n",
+           (unsigned long long)(c.fg_pulses / fg_pulses_per_motor_rev),
+           (double)c.powered_us / 3.6e9, (double)c.duty_us / 3.6e9,
+           (unsigned long)c.moves, (unsigned long)c.stalls, (unsigned long)c.timeouts);
+    printf("[MAINT] nudges=%lu reversals=%lu boots=%lu line_out_m=%.3f line_travel_m=%.1f\n",
+           (unsigned long)c.nudges, (unsigned long)c.reversals, (unsigned long)c.boots,
+           (double)((float)c.line_out_pulses / pulses_per_meter), (double)c.line_travel_m);
+}
@@ -0,0 +1,335 @@
+#pragma once
+
+// Runtime parameter registry.
+// Every tunable lives in one ParamSet, described by a table of IDs, names, types, units and
+// bounds. Edits go to a staging copy; commit publishes it into the standby buffer and the
+// control loop flips buffers at the next tick, so a loop iteration never sees a half-written set.
+// No hardware access here.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "winch_variants.h"
+
+enum ParamType : uint8_t {
+    PARAM_F32 = 0,
+    PARAM_U32 = 1,
+};
+
+struct ParamSet {
+    // move_meters
+    float    padding_m;
+    float    padding_speed;
+    uint32_t stall_window_us;
+    float    slew_rate;
+    float    brake_rate;
+
+    // closed-loop speed control (set by autotune)
+    uint32_t closed_loop;
+    float    speed_kp;
+    float    speed_ki;
+    float    pos_kp;
+    uint32_t gain_sched;       // gains/slew/stall limits from the schedule instead of the above
+    uint32_t gravity_ff;       // add the payload's weight (payload_kg) to the speed-loop output
+
+    // hold_payload_ms
+    float    nudge_speed;
+    uint32_t deadband_pulses;
+    uint32_t nudge_max_pulses; // upper bound on one nudge; the actual size follows the slip
+    uint32_t nudge_min_gap_ms; // minimum gap between nudges, on top of the settle time
+    uint32_t hold_mode;        // 0 nudge at zero duty, 1 holding torque
+    float    payload_kg;       // 0 = unknown
+    float    hold_duty_per_kg; // balance duty per kg of payload (hold cal)
+    float    hold_kp;          // position proportional term of the holding torque (damping,
+                               // critical at 2 sqrt(hold_ki / K))
+    float    hold_ki;          // position integrator of the holding torque
+    float    hold_max_duty;
+
+    // hardware
+    uint32_t variant;          // WinchVariantId, read at boot only
+
+    // line wear map
+    uint32_t wear_alert_passes;  // alert when a segment reaches this many passes (0 = off)
+    uint32_t line_loaded;        // payload attached: driven passes count as wear
+
+    // input shaper on the speed reference while a speed loop is closed, else on the duty
+    uint32_t shaper_mode;        // ShaperMode: 0 off, 1 ZV, 2 ZVD
+    float    shaper_freq_hz;     // payload bounce mode
+    float    shaper_zeta;        // its damping ratio
+
+    // active swing damping
+    uint32_t swing_source;       // 0 off, 1 swing angle over the command link, 2 tension ADC
+    float    swing_mod_rate;     // line speed amplitude of the modulation
+    float    swing_min_angle;    // deadband on swing angle
+    float    swing_min_ripple;   // deadband on relative tension ripple
+    float    swing_max_exc;      // line excursion limit around the start length
+    float    swing_pos_kp;       // pull back toward the start length
+
+    // rangefinder / lower to height
+    uint32_t range_source;       // 0 off, 1 TFmini-style UART, 2 LIDAR-Lite v3 I2C
+    float    range_offset_m;     // reading when the payload touches the ground
+    float    descent_decel;      // deceleration into the target height
+    float    descent_creep;      // slowest approach speed
+
+    // mission cycle in main(): unwind, hold, wind, pause
+    float    cycle_m;            // unwound and wound back each cycle
+    uint32_t cycle_hold_ms;
+    float    cycle_speed;        // cruise duty of both moves
+    uint32_t cycle_pause_ms;     // idle between cycles (cooling)
+};
+
+struct ParamDef {
+    uint16_t    id;
+    const char* name;
+    ParamType   type;
+    const char* unit;
+    float       min_v;
+    float       max_v;
+    float       def_v;
+    uint16_t    offset;
+};
+
+#define PARAM_F(id, field, unit, lo, hi, def) \
+    { id, #field, PARAM_F32, unit, lo, hi, def, (uint16_t)offsetof(ParamSet, field) }
+#define PARAM_U(id, field, unit, lo, hi, def) \
+    { id, #field, PARAM_U32, unit, lo, hi, def, (uint16_t)offsetof(ParamSet, field) }
+
+// IDs are stable: they are what gets persisted and what the command link accepts.
+// Never reuse an ID for a different meaning. Retired, do not reuse:
+//   22 nudge_pulses, 23 nudge_gap_ms (fixed nudge size and gap, before nudges followed the slip)
+static const ParamDef PARAM_DEFS[] = {
+    PARAM_F( 1, padding_m,       "m",      0.0f,    5.0f,      0.2f),
+    PARAM_F( 2, padding_speed,   "%",      1.0f,    100.0f,    50.0f),
+    PARAM_U( 3, stall_window_us, "us",     50000,   5000000,   500000),
+    PARAM_F( 4, slew_rate,       "%/s",    1.0f,    5000.0f,   200.0f),
+    PARAM_F( 5, brake_rate,      "%/s",    1.0f,    5000.0f,   400.0f),
+
+    PARAM_U(10, closed_loop,     "bool",   0,       1,         0),
+    PARAM_F(11, speed_kp,        "%/pps",  0.0f,    10.0f,     0.0f),
+    PARAM_F(12, speed_ki,        "%/p",    0.0f,    10.0f,     0.0f),
+    PARAM_F(13, pos_kp,          "1/s",    0.0f,    100.0f,    0.0f),
+    PARAM_U(14, gain_sched,      "bool",   0,       1,         0),
+    PARAM_U(15, gravity_ff,      "bool",   0,       1,         1),
+
+    PARAM_F(20, nudge_speed,     "%",      1.0f,    100.0f,    50.0f),
+    PARAM_U(21, deadband_pulses, "pulses", 0,       1000,      1),
+    PARAM_U(24, hold_mode,       "enum",   0,       1,         0),
+    PARAM_F(25, payload_kg,      "kg",     0.0f,    100.0f,    0.0f),
+    PARAM_F(26, hold_duty_per_kg, "%/kg",  0.0f,    100.0f,    0.0f),
+    PARAM_F(29, hold_kp,         "%/p",    0.0f,    10.0f,     0.5f),
+    PARAM_F(27, hold_ki,         "%/p/s",  0.0f,    1.0f,      0.5f),
+    PARAM_F(28, hold_max_duty,   "%",      0.0f,    100.0f,    40.0f),
+    PARAM_U(90, nudge_max_pulses, "pulses", 1,      10000,     400),
+    PARAM_U(91, nudge_min_gap_ms, "ms",    0,       60000,     0),
+
+    PARAM_U(30, variant,         "idx",    0,       WINCH_VARIANT_COUNT - 1, WINCH_VARIANT),
+
+    PARAM_U(40, wear_alert_passes, "passes", 0,     131070,    5000),
+    PARAM_U(41, line_loaded,       "bool",   0,     1,         1),
+
+    PARAM_U(50, shaper_mode,     "enum",   0,       2,         0),
+    PARAM_F(51, shaper_freq_hz,  "Hz",     0.4f,    20.0f,     2.0f),
+    PARAM_F(52, shaper_zeta,     "",       0.0f,    0.9f,      0.05f),
+
+    PARAM_U(60, swing_source,     "enum",  0,       2,         0),
+    PARAM_F(61, swing_mod_rate,   "m/s",   0.0f,    1.0f,      0.25f),
+    PARAM_F(62, swing_min_angle,  "rad",   0.0f,    0.5f,      0.01f),
+    PARAM_F(63, swing_min_ripple, "",      0.0f,    0.5f,      0.002f),
+    PARAM_F(64, swing_max_exc,    "m",     0.0f,    2.0f,      0.3f),
+    PARAM_F(65, swing_pos_kp,     "1/s",   0.0f,    5.0f,      0.2f),
+
+    PARAM_U(70, range_source,     "enum",  0,       2,         0),
+    PARAM_F(71, range_offset_m,   "m",     -5.0f,   5.0f,      0.0f),
+    PARAM_F(72, descent_decel,    "m/s2",  0.05f,   5.0f,      0.5f),
+    PARAM_F(73, descent_creep,    "m/s",   0.005f,  0.5f,      0.03f),
+
+    PARAM_F(80, cycle_m,          "m",     0.0f,    25.0f,     0.6f),
+    PARAM_U(81, cycle_hold_ms,    "ms",    0,       3600000,   2000),
+    PARAM_F(82, cycle_speed,      "%",     1.0f,    100.0f,    100.0f),
+    PARAM_U(83, cycle_pause_ms,   "ms",    0,       3600000,   5000),
+};
+
+static constexpr size_t PARAM_COUNT = sizeof(PARAM_DEFS) / sizeof(PARAM_DEFS[0]);
+
+// Look up by name or by numeric ID
+static inline const ParamDef* param_find(const char* key) {
+    char* end;
+    unsigned long id = strtoul(key, &end, 10);
+    bool numeric = (end != key && *end == '\0');
+
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        if (numeric ? PARAM_DEFS[i].id == id : strcmp(PARAM_DEFS[i].name, key) == 0) {
+            return &PARAM_DEFS[i];
+        }
+    }
+    return nullptr;
+}
+
+static inline const ParamDef* param_find_id(uint16_t id) {
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        if (PARAM_DEFS[i].id == id) return &PARAM_DEFS[i];
+    }
+    return nullptr;
+}
+
+static inline float param_get(const ParamSet& s, const ParamDef& d) {
+    const uint8_t* p = (const uint8_t*)&s + d.offset;
+    if (d.type == PARAM_U32) return (float)*(const uint32_t*)p;
+    return *(const float*)p;
+}
+
+// Rejects out-of-range or non-finite values; integers are rounded
+static inline bool param_set(ParamSet& s, const ParamDef& d, float v) {
+    if (!(v >= d.min_v && v <= d.max_v)) return false;
+
+    uint8_t* p = (uint8_t*)&s + d.offset;
+    if (d.type == PARAM_U32) *(uint32_t*)p = (uint32_t)(v + 0.5f);
+    else                     *(float*)p = v;
+    return true;
+}
+
+static inline void params_defaults(ParamSet& s) {
+    memset(&s, 0, sizeof(s));
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        param_set(s, PARAM_DEFS[i], PARAM_DEFS[i].def_v);
+    }
+}
+
+// ---- Double-buffered bank ----
+
+struct ParamBank {
+    ParamSet sets[2];
+    ParamSet staging;          // command-link edits land here
+    volatile uint8_t active;   // index the control loop reads
+    volatile bool pending;     // standby holds a committed set not yet live
+};
+
+static inline void param_bank_init(ParamBank& b) {
+    params_defaults(b.sets[0]);
+    b.sets[1] = b.sets[0];
+    b.staging = b.sets[0];
+    b.active  = 0;
+    b.pending = false;
+}
+
+// Publish staging into the standby buffer; goes live at the next tick
+static inline void param_bank_commit(ParamBank& b) {
+    b.sets[b.active ^ 1] = b.staging;
+    b.pending = true;
+}
+
+// Called only at a control-tick boundary. Returns true when a new set went live.
+static inline bool param_bank_tick(ParamBank& b) {
+    if (!b.pending) return false;
+
+    b.active ^= 1;
+    b.pending = false;
+    return true;
+}
+
+// The newest committed set: the standby one while a commit waits for the next tick
+static inline const ParamSet& param_bank_latest(const ParamBank& b) {
+    return b.sets[b.pending ? b.active ^ 1 : b.active];
+}
+
+// ---- Persistence format: (id, raw bits) pairs, so adding parameters keeps old records usable ----
+
+static constexpr size_t PARAM_RECORD_MAX = 64;
+
+struct ParamRecordEntry {
+    uint16_t id;    // 0 = unused
+    uint16_t type;
+    uint32_t raw;
+};
+
+struct ParamRecord {
+    ParamRecordEntry e[PARAM_RECORD_MAX];
+};
+
+static inline void params_to_record(const ParamSet& s, ParamRecord& r) {
+    memset(&r, 0, sizeof(r));
+    for (size_t i = 0; i < PARAM_COUNT && i < PARAM_RECORD_MAX; i++) {
+        const ParamDef& d = PARAM_DEFS[i];
+        r.e[i].id   = d.id;
+        r.e[i].type = d.type;
+        memcpy(&r.e[i].raw, (const uint8_t*)&s + d.offset, 4);
+    }
+}
+
+// Leave a parameter out of a record, so loading it keeps whatever the loader seeded
+static inline void param_record_drop(ParamRecord& r, const char* key) {
+    const ParamDef* d = param_find(key);
+    for (size_t i = 0; d && i < PARAM_RECORD_MAX; i++) {
+        if (r.e[i].id == d->id) r.e[i] = {0, 0, 0};
+    }
+}
+
+// Unknown IDs, type mismatches and out-of-range values keep the current value.
+// Returns the number of parameters applied.
+static inline size_t params_from_record(ParamSet& s, const ParamRecord& r) {
+    size_t applied = 0;
+    for (size_t i = 0; i < PARAM_RECORD_MAX; i++) {
+        const ParamDef* d = param_find_id(r.e[i].id);
+        if (!d || r.e[i].type != d->type) continue;
+
+        float v;
+        if (d->type == PARAM_U32) v = (float)r.e[i].raw;
+        else memcpy(&v, &r.e[i].raw, 4);
+
+        if (param_set(s, *d, v)) applied++;
+    }
+    return applied;
+}
+
+static inline void param_print(const ParamSet& s, const ParamDef& d) {
+    printf("[PARAM] id=%u name=%s value=%g unit=%s min=%g max=%g\n",
+           (unsigned)d.id, d.name, (double)param_get(s, d), d.unit, (double)d.min_v, (double)d.max_v);
+}
+
+// "param list | get <key> | set <key> <value> | commit | reset" on the staging/live sets.
+// Persisting (save/load) needs flash and is handled by the caller.
+static inline bool params_command(ParamBank& b, int argc, char** argv) {
+    if (argc < 2) return false;
+    const char* sub = argv[1];
+
+    if (strcmp(sub, "list") == 0) {
+        for (size_t i = 0; i < PARAM_COUNT; i++) param_print(b.sets[b.active], PARAM_DEFS[i]);
+        return true;
+    }
+
+    if (strcmp(sub, "get") == 0 && argc == 3) {
+        const ParamDef* d = param_find(argv[2]);
+        if (!d) return false;
+        param_print(b.sets[b.active], *d);
+        return true;
+    }
+
+    if (strcmp(sub, "set") == 0 && argc == 4) {
+        const ParamDef* d = param_find(argv[2]);
+        if (!d) return false;
+
+        char* end;
+        float v = strtof(argv[3], &end);
+        if (end == argv[3] || *end != '\0') return false;
+        if (!param_set(b.staging, *d, v)) return false;
+
+        param_print(b.staging, *d);
+        return true;
+    }
+
+    if (strcmp(sub, "commit") == 0) {
+        param_bank_commit(b);
+        printf("[PARAM] committed\n");
+        return true;
+    }
+
+    if (strcmp(sub, "reset") == 0) {
+        params_defaults(b.staging);
+        printf("[PARAM] staging reset to defaults (commit to apply)\n");
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+// Payload height from a downward-looking rangefinder, fused with line-out.
+// Frames are the 9-byte Benewake TFmini/TF-Luna UART format (also what the host simulator
+// emits): 0x59 0x59 distL distH strengthL strengthH tempL tempH checksum, distance in cm.
+// Between (or instead of missing) readings, the height follows the line paid out; readings
+// pull it back with a scalar Kalman update and are gated against outliers.
+// No hardware access here.
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+static constexpr uint8_t  RANGE_FRAME_HEAD     = 0x59;
+static constexpr uint32_t RANGE_FRAME_LEN      = 9;
+static constexpr uint16_t RANGE_MIN_STRENGTH   = 100;     // weaker returns are unreliable
+static constexpr uint16_t RANGE_BAD_STRENGTH   = 0xFFFF;  // saturated
+
+struct RangeParser {
+    uint8_t  buf[RANGE_FRAME_LEN];
+    uint32_t n;
+};
+
+static inline void range_encode_frame(uint8_t out[RANGE_FRAME_LEN], float dist_m, uint16_t strength) {
+    uint32_t cm = (dist_m > 0.0f) ? (uint32_t)(dist_m * 100.0f + 0.5f) : 0;
+    if (cm > 0xFFFF) cm = 0xFFFF;
+
+    out[0] = RANGE_FRAME_HEAD;
+    out[1] = RANGE_FRAME_HEAD;
+    out[2] = (uint8_t)(cm & 0xFF);
+    out[3] = (uint8_t)(cm >> 8);
+    out[4] = (uint8_t)(strength & 0xFF);
+    out[5] = (uint8_t)(strength >> 8);
+    out[6] = 0;
+    out[7] = 0;
+
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < RANGE_FRAME_LEN - 1; i++) sum += out[i];
+    out[8] = sum;
+}
+
+// Feed one byte; returns true when it completed a frame with a good checksum and a usable
+// return, with the distance in *dist_m. Resynchronises on the two header bytes.
+static inline bool range_parse_byte(RangeParser& p, uint8_t b, float* dist_m) {
+    if (p.n < 2 && b != RANGE_FRAME_HEAD) {
+        p.n = 0;
+        return false;
+    }
+    if (p.n >= RANGE_FRAME_LEN) p.n = 0;   // never past the buffer, whatever the state was
+    p.buf[p.n++] = b;
+    if (p.n < RANGE_FRAME_LEN) return false;
+    p.n = 0;
+
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < RANGE_FRAME_LEN - 1; i++) sum += p.buf[i];
+    if (sum != p.buf[8]) {
+        // a header pair inside the bad frame may start the real one: keep from there
+        for (uint32_t i = 1; i + 1 < RANGE_FRAME_LEN; i++) {
+            if (p.buf[i] == RANGE_FRAME_HEAD && p.buf[i + 1] == RANGE_FRAME_HEAD) {
+                p.n = RANGE_FRAME_LEN - i;
+                memmove(p.buf, p.buf + i, p.n);
+                break;
+            }
+        }
+        return false;
+    }
+
+    uint16_t cm       = (uint16_t)(p.buf[2] | (p.buf[3] << 8));
+    uint16_t strength = (uint16_t)(p.buf[4] | (p.buf[5] << 8));
+    if (strength < RANGE_MIN_STRENGTH || strength == RANGE_BAD_STRENGTH || cm == 0) return false;
+
+    *dist_m = (float)cm * 0.01f;
+    return true;
+}
+
+// ---- Fusion ----
+
+struct HeightFusion {
+    float    h;           // payload height above ground (m)
+    float    var;         // its variance (m^2)
+    bool     valid;       // had at least one reading
+    uint32_t rejects;     // consecutive gated-out readings
+};
+
+static constexpr float RANGE_MEAS_VAR   = 0.02f * 0.02f;  // per reading
+static constexpr float RANGE_LINE_VAR_M = 0.01f;          // line-out growth per metre paid out (stretch, slip)
+
+static inline void height_reset(HeightFusion& f) {
+    memset(&f, 0, sizeof(f));
+}
+
+// Payload went down by the line paid out (negative when winding in)
+static inline void height_predict(HeightFusion& f, float paid_out_m) {
+    if (!f.valid) return;
+    f.h -= paid_out_m;
+    f.var += RANGE_LINE_VAR_M * fabsf(paid_out_m) + 1e-6f;
+}
+
+// Returns false if the reading was gated out. A run of rejects means the prediction is the
+// one that is wrong (e.g. slipped line): start over from the reading.
+static inline bool height_correct(HeightFusion& f, float z_m) {
+    if (!f.valid || f.rejects >= 5) {
+        f.h = z_m;
+        f.var = RANGE_MEAS_VAR;
+        f.valid = true;
+        f.rejects = 0;
+        return true;
+    }
+
+    float s = f.var + RANGE_MEAS_VAR;
+    float innov = z_m - f.h;
+    if (innov * innov > 9.0f * s + 0.05f * 0.05f) {
+        f.rejects++;
+        return false;
+    }
+
+    float k = f.var / s;
+    f.h += k * innov;
+    f.var *= (1.0f - k);
+    f.rejects = 0;
+    return true;
+}
+
+// Descent speed (m/s) that reaches target_m with constant deceleration, never below creep.
+// stop_m is the distance still travelled after the stop command.
+static inline float descent_speed_mps(float h_m, float target_m, float stop_m,
+                                      float v_max, float decel, float v_creep) {
+    float d = h_m - target_m - stop_m;
+    float v = (d > 0.0f) ? sqrtf(2.0f * decel * d) : 0.0f;
+
+    if (v > v_max)   v = v_max;
+    if (v < v_creep) v = v_creep;
+    return v;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+// Persistent records in the last sectors of flash.
+// Each slot is one 4 KB sector used as an append log of page-aligned records, so a save
+// only erases the sector when it is full. Load returns the newest record with a good CRC.
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include <stdint.h>
+#include <string.h>
+
+enum StoreSlot : uint32_t {
+    STORE_SLOT_TUNE   = 0,   // identified plant + autotune result
+    STORE_SLOT_PARAMS = 1,   // runtime parameter set
+    STORE_SLOT_MAINT  = 2,   // lifetime usage counters
+    STORE_SLOT_WEAR   = 3,   // line wear map
+    STORE_SLOT_COUNT
+};
+
+static constexpr uint32_t STORE_MAGIC = 0x57494E43; // "WINC"
+
+struct StoreHeader {
+    uint32_t magic;
+    uint16_t kind;     // record type/version, must match on load
+    uint16_t len;      // payload bytes
+    uint32_t seq;      // increases with every save to the slot
+    uint32_t crc;      // CRC-32 of the payload
+};
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t store_slot_offset(uint32_t slot) {
+    return PICO_FLASH_SIZE_BYTES - (slot + 1) * FLASH_SECTOR_SIZE;
+}
+
+static uint32_t store_record_pages(size_t len) {
+    return (uint32_t)((sizeof(StoreHeader) + len + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE);
+}
+
+// Walk the slot. Returns the newest valid record (or nullptr) and the first free page.
+static const StoreHeader* store_scan(uint32_t slot, uint16_t kind, uint32_t* free_page) {
+    const uint8_t* base = (const uint8_t*)(XIP_BASE + store_slot_offset(slot));
+    const uint32_t pages = FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE;
+    const StoreHeader* best = nullptr;
+
+    uint32_t page = 0;
+    while (page < pages) {
+        const StoreHeader* h = (const StoreHeader*)(base + page * FLASH_PAGE_SIZE);
+
+        if (h->magic == 0xFFFFFFFFu) break; // erased: end of log
+
+        uint32_t n = store_record_pages(h->len);
+        bool fits = h->magic == STORE_MAGIC && page + n <= pages;
+
+        if (fits && h->kind == kind &&
+            crc32_update(0, (const uint8_t*)(h + 1), h->len) == h->crc &&
+            (!best || h->seq > best->seq)) {
+            best = h;
+        }
+
+        // a torn or foreign record only costs its first page
+        page += fits ? n : 1;
+    }
+
+    *free_page = page;
+    return best;
+}
+
+static bool store_load(uint32_t slot, uint16_t kind, void* out, size_t len) {
+    uint32_t free_page;
+    const StoreHeader* h = store_scan(slot, kind, &free_page);
+    if (!h || h->len != len) return false;
+
+    memcpy(out, h + 1, len);
+    return true;
+}
+
+static bool store_save(uint32_t slot, uint16_t kind, const void* data, size_t len) {
+    static uint8_t buf[FLASH_SECTOR_SIZE];
+
+    if (slot >= STORE_SLOT_COUNT || sizeof(StoreHeader) + len > sizeof(buf)) return false;
+
+    uint32_t free_page;
+    const StoreHeader* prev = store_scan(slot, kind, &free_page);
+
+    StoreHeader h;
+    h.magic = STORE_MAGIC;
+    h.kind  = kind;
+    h.len   = (uint16_t)len;
+    h.seq   = prev ? prev->seq + 1 : 1;
+    h.crc   = crc32_update(0, (const uint8_t*)data, len);
+
+    uint32_t n = store_record_pages(len);
+    memset(buf, 0xFF, n * FLASH_PAGE_SIZE);
+    memcpy(buf, &h, sizeof(h));
+    memcpy(buf + sizeof(h), data, len);
+
+    const uint32_t pages = FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE;
+    bool erase = free_page + n > pages;
+    uint32_t off = store_slot_offset(slot) + (erase ? 0 : free_page * FLASH_PAGE_SIZE);
+
+    // Flash is unavailable for XIP while erasing/programming
+    uint32_t ints = save_and_disable_interrupts();
+    if (erase) flash_range_erase(store_slot_offset(slot), FLASH_SECTOR_SIZE);
+    flash_range_program(off, buf, n * FLASH_PAGE_SIZE);
+    restore_interrupts(ints);
+
+    return true;
+}
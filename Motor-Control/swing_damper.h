@@ -0,0 +1,83 @@
+#pragma once
+
+// Active swing damping by modulating line length.
+// Line tension peaks twice per swing (at the bottom) and dips at the extremes. Paying line out
+// while tension is high and taking it in while it is low does negative work on the pendulum,
+// so the winch rate is commanded in phase with the tension ripple. The ripple is normalised by
+// its own size, so the line moves by about the same amount whatever the swing amplitude and
+// every swing loses a fixed fraction of its energy (exponential decay):
+//   from swing angle/rate:  Ldot = v_mod * (thetadot^2 - w^2 theta^2) / (thetadot^2 + w^2 theta^2)
+//   from a tension signal:  Ldot = v_mod * (T / T_mean - 1) / ripple
+// A weak position term keeps the line near the length damping started at.
+// No hardware access here.
+
+#include <math.h>
+#include <stdint.h>
+#include "winch_model.h"
+#include "control_law.h"
+
+static constexpr float SWING_G = 9.81f;
+
+struct SwingDamperCfg {
+    float mod_rate_mps;     // line speed amplitude of the modulation
+    float min_angle_rad;    // swings smaller than this are left alone
+    float min_ripple;       // same for relative tension ripple
+    float max_excursion_m;  // keep the line within this of the start length
+    float pos_kp;           // 1/s pull back toward the start length
+};
+
+static inline float swing_limit_rate(const SwingDamperCfg& c, float rate, float excursion_m) {
+    rate -= c.pos_kp * excursion_m;
+
+    if (excursion_m >  c.max_excursion_m && rate > 0) rate = 0;
+    if (excursion_m < -c.max_excursion_m && rate < 0) rate = 0;
+    float lim = c.mod_rate_mps * 1.5f;
+    if (rate >  lim) rate =  lim;
+    if (rate < -lim) rate = -lim;
+    return rate;
+}
+
+// Line rate (m/s, + = pay out) from swing angle (rad) and rate (rad/s) at line length L
+static inline float swing_rate_from_angle(const SwingDamperCfg& c, float theta, float theta_dot,
+                                          float line_m, float excursion_m) {
+    if (line_m < 0.3f) line_m = 0.3f;
+    float w2 = SWING_G / line_m;
+
+    float kin = theta_dot * theta_dot;
+    float pot = w2 * theta * theta;
+    float rate = c.mod_rate_mps * (kin - pot) / (kin + pot + w2 * c.min_angle_rad * c.min_angle_rad);
+
+    return swing_limit_rate(c, rate, excursion_m);
+}
+
+// Same from tension, its running mean and the running size of its relative ripple
+static inline float swing_rate_from_tension(const SwingDamperCfg& c, float tension, float tension_mean,
+                                            float ripple, float excursion_m) {
+    if (tension_mean <= 0.0f) return 0.0f;
+    if (ripple < c.min_ripple) ripple = c.min_ripple;
+
+    float rate = c.mod_rate_mps * (tension / tension_mean - 1.0f) / ripple;
+    if (rate >  c.mod_rate_mps) rate =  c.mod_rate_mps;
+    if (rate < -c.mod_rate_mps) rate = -c.mod_rate_mps;
+
+    return swing_limit_rate(c, rate, excursion_m);
+}
+
+// Bidirectional drive on a one-direction duty output: the DIR line only changes once the
+// applied duty has come down to (near) zero, otherwise the target is zero first.
+struct ReversingDrive {
+    bool paying_out;   // current DIR meaning
+};
+
+// Returns the duty target for a signed line rate (m/s, + = pay out); updates direction
+static inline float reversing_drive_step(ReversingDrive& d, const PlantParams& p,
+                                         float rate_mps, float applied_duty) {
+    bool want_out = rate_mps > 0.0f;
+    float pps = fabsf(rate_mps) * p.pulses_per_meter;
+
+    if (pps > 0.0f && want_out != d.paying_out) {
+        if (applied_duty > 1.0f) return 0.0f;  // slow down before reversing
+        d.paying_out = want_out;
+    }
+    return duty_for_speed(p, pps);
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+// Compact trace stream for the on-device trace buffer.
+// Records as in trace_file.h (edges, control samples, events), but each one stored as the
+// difference from what the decoder already knows, in zig-zag varints:
+//  - an edge is the change of its interval from the previous edge's interval, plus whether the
+//    line went out or in (a running drum has near-constant intervals: 1-2 bytes per edge)
+//  - a sample is the time since the previous record and the change of position and duty
+//  - an event is the time since the previous record, its id and the position correction
+//  - a sync restarts the chain with absolute position and duty: at the start, and before an
+//    edge after a long gap (keeps edge intervals small and bounds a corrupted span)
+// First varint of a record: (payload << 2) | tag. Typical missions pack 6-10x smaller than
+// 12-byte TraceRecords.
+// The decoder validates every field and stops at the first inconsistency (trace_dec_next
+// false, error set); it never reads outside the buffer.
+// No hardware access here.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "trace_file.h"
+
+static constexpr uint32_t TRACE_EDGE_GAP_US = 1000000;   // longer edge gaps get a sync
+static constexpr uint32_t TRACE_ENC_MAX_RECORD = 24;     // bytes, worst case
+
+enum TraceTag : uint8_t {
+    TRACE_TAG_EDGE_OUT = 0,   // payload: zz(interval - previous interval)
+    TRACE_TAG_EDGE_IN  = 1,
+    TRACE_TAG_SAMPLE   = 2,   // payload: dt; then zz(d pos), zz(d duty)
+    TRACE_TAG_OTHER    = 3,   // payload: dt; then sub: 0 = sync (zz pos, zz duty), else event id (zz d pos)
+};
+
+static inline uint32_t trace_zz(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t trace_unzz(uint32_t u) {
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+static inline uint32_t trace_put_varint(uint8_t* p, uint64_t v) {
+    uint32_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// False on a truncated or over-long varint
+static inline bool trace_get_varint(const uint8_t** p, const uint8_t* end, uint64_t* v) {
+    uint64_t out = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7) {
+        if (*p >= end) return false;
+        uint8_t b = *(*p)++;
+        out |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = out;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline bool trace_get_u32(const uint8_t** p, const uint8_t* end, uint32_t* v) {
+    uint64_t x;
+    if (!trace_get_varint(p, end, &x) || x > 0xFFFFFFFFull) return false;
+    *v = (uint32_t)x;
+    return true;
+}
+
+// ---- Encoder ----
+
+struct TraceEncoder {
+    uint8_t* buf;
+    uint32_t cap;
+    uint32_t len;
+    uint32_t records;
+    bool     started;
+    bool     full;       // a record didn't fit; nothing is written after it
+
+    // what the decoder knows after the last record
+    uint32_t t_last;     // us, wrapping
+    uint32_t t_edge;
+    uint32_t iv_edge;
+    int32_t  pos;
+    int16_t  duty_c;
+};
+
+static inline void trace_enc_init(TraceEncoder& e, uint8_t* buf, uint32_t cap) {
+    e.buf = buf;
+    e.cap = cap;
+    e.len = 0;
+    e.records = 0;
+    e.started = false;
+    e.full = false;
+    e.t_last = e.t_edge = e.iv_edge = 0;
+    e.pos = 0;
+    e.duty_c = 0;
+}
+
+static inline int16_t trace_duty_c(float duty_pct) {
+    float c = duty_pct * 100.0f;
+    return (int16_t)(c > 32767.0f ? 32767.0f : (c < -32767.0f ? -32767.0f : c));
+}
+
+static inline bool trace_enc_commit(TraceEncoder& e, const uint8_t* rec, uint32_t n) {
+    if (e.full || e.len + n > e.cap) {
+        e.full = true;
+        return false;
+    }
+    memcpy(e.buf + e.len, rec, n);
+    e.len += n;
+    e.records++;
+    return true;
+}
+
+// Time since the last record; a clock read before the previous record counts as no time
+static inline uint32_t trace_enc_dt(const TraceEncoder& e, uint32_t t_us) {
+    uint32_t dt = t_us - e.t_last;
+    return (dt > 0x7FFFFFFFu) ? 0 : dt;
+}
+
+static inline bool trace_enc_sync(TraceEncoder& e, uint32_t t_us, int32_t pos, int16_t duty_c) {
+    uint8_t rec[TRACE_ENC_MAX_RECORD];
+    uint32_t dt = e.started ? trace_enc_dt(e, t_us) : t_us;
+
+    uint32_t n = trace_put_varint(rec, ((uint64_t)dt << 2) | TRACE_TAG_OTHER);
+    rec[n++] = 0;
+    n += trace_put_varint(rec + n, trace_zz(pos));
+    n += trace_put_varint(rec + n, trace_zz(duty_c));
+    if (!trace_enc_commit(e, rec, n)) return false;
+
+    e.started = true;
+    e.t_last = e.t_edge = e.t_last + dt;
+    e.iv_edge = 0;
+    e.pos = pos;
+    e.duty_c = duty_c;
+    return true;
+}
+
+// Starts a stream (discarding what the buffer held)
+static inline bool trace_enc_start(TraceEncoder& e, uint32_t t_us, int32_t pos, int16_t duty_c) {
+    trace_enc_init(e, e.buf, e.cap);
+    return trace_enc_sync(e, t_us, pos, duty_c);
+}
+
+static inline bool trace_enc_edge(TraceEncoder& e, uint32_t t_us, bool paying_out) {
+    if (!e.started) return false;
+
+    uint32_t iv = trace_enc_dt(e, t_us) + (e.t_last - e.t_edge);
+    if (iv > TRACE_EDGE_GAP_US) {
+        if (!trace_enc_sync(e, t_us, e.pos, e.duty_c)) return false;
+        iv = trace_enc_dt(e, t_us) + (e.t_last - e.t_edge);
+    }
+
+    uint8_t rec[TRACE_ENC_MAX_RECORD];
+    int32_t dd = (int32_t)(iv - e.iv_edge);
+    uint32_t n = trace_put_varint(rec, ((uint64_t)trace_zz(dd) << 2) |
+                                       (paying_out ? TRACE_TAG_EDGE_OUT : TRACE_TAG_EDGE_IN));
+    if (!trace_enc_commit(e, rec, n)) return false;
+
+    e.t_edge += iv;
+    e.t_last = e.t_edge;
+    e.iv_edge = iv;
+    e.pos = (int32_t)((uint32_t)e.pos + (paying_out ? 1u : 0xFFFFFFFFu));
+    return true;
+}
+
+static inline bool trace_enc_sample(TraceEncoder& e, uint32_t t_us, int32_t pos, int16_t duty_c) {
+    if (!e.started) return false;
+
+    uint8_t rec[TRACE_ENC_MAX_RECORD];
+    uint32_t dt = trace_enc_dt(e, t_us);
+    uint32_t n = trace_put_varint(rec, ((uint64_t)dt << 2) | TRACE_TAG_SAMPLE);
+    n += trace_put_varint(rec + n, trace_zz((int32_t)((uint32_t)pos - (uint32_t)e.pos)));
+    n += trace_put_varint(rec + n, trace_zz(duty_c - e.duty_c));
+    if (!trace_enc_commit(e, rec, n)) return false;
+
+    e.t_last += dt;
+    e.pos = pos;
+    e.duty_c = duty_c;
+    return true;
+}
+
+static inline bool trace_enc_event(TraceEncoder& e, uint32_t t_us, TraceEvent ev, int32_t pos) {
+    if (!e.started || ev == 0) return false;
+
+    uint8_t rec[TRACE_ENC_MAX_RECORD];
+    uint32_t dt = trace_enc_dt(e, t_us);
+    uint32_t n = trace_put_varint(rec, ((uint64_t)dt << 2) | TRACE_TAG_OTHER);
+    rec[n++] = (uint8_t)ev;
+    n += trace_put_varint(rec + n, trace_zz((int32_t)((uint32_t)pos - (uint32_t)e.pos)));
+    if (!trace_enc_commit(e, rec, n)) return false;
+
+    e.t_last += dt;
+    e.pos = pos;
+    return true;
+}
+
+// ---- Decoder ----
+
+struct TraceDecoder {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool     synced;
+    bool     error;
+
+    uint64_t t_last;     // us, extended past the 32-bit wrap
+    uint64_t t_edge;
+    uint32_t iv_edge;
+    int32_t  pos;
+    int16_t  duty_c;
+};
+
+static inline void trace_dec_init(TraceDecoder& d, const uint8_t* buf, size_t len) {
+    d.p = buf;
+    d.end = buf + len;
+    d.synced = false;
+    d.error = false;
+    d.t_last = d.t_edge = 0;
+    d.iv_edge = 0;
+    d.pos = 0;
+    d.duty_c = 0;
+}
+
+static inline bool trace_dec_fail(TraceDecoder& d) {
+    d.error = true;
+    return false;
+}
+
+// Next edge, sample or event (syncs are consumed); rec->dt_us is since the previous record
+// returned. False at the end of the stream, or on corruption with d.error set.
+static inline bool trace_dec_next(TraceDecoder& d, TraceRecord* rec, uint64_t* t_us) {
+    uint64_t t_prev = d.t_last;
+
+    while (!d.error && d.p < d.end) {
+        uint64_t head;
+        if (!trace_get_varint(&d.p, d.end, &head)) return trace_dec_fail(d);
+        uint8_t tag = (uint8_t)(head & 3);
+        uint64_t payload = head >> 2;
+        if (payload > 0xFFFFFFFFull) return trace_dec_fail(d);
+
+        if (tag == TRACE_TAG_EDGE_OUT || tag == TRACE_TAG_EDGE_IN) {
+            if (!d.synced) return trace_dec_fail(d);
+            uint32_t iv = d.iv_edge + (uint32_t)trace_unzz((uint32_t)payload);
+            if (iv > TRACE_EDGE_GAP_US || d.t_edge + iv < d.t_last) return trace_dec_fail(d);
+
+            d.iv_edge = iv;
+            d.t_edge += iv;
+            d.t_last = d.t_edge;
+            d.pos = (int32_t)((uint32_t)d.pos + (tag == TRACE_TAG_EDGE_OUT ? 1u : 0xFFFFFFFFu));
+            rec->kind = TRACE_EDGE;
+            rec->arg = 1;
+        } else if (tag == TRACE_TAG_SAMPLE) {
+            uint32_t dpos, dduty;
+            if (!d.synced) return trace_dec_fail(d);
+            if (!trace_get_u32(&d.p, d.end, &dpos) || !trace_get_u32(&d.p, d.end, &dduty)) {
+                return trace_dec_fail(d);
+            }
+            int32_t duty = (int32_t)d.duty_c + trace_unzz(dduty);
+            if (duty < -32767 || duty > 32767) return trace_dec_fail(d);
+
+            d.t_last += payload;
+            d.pos = (int32_t)((uint32_t)d.pos + (uint32_t)trace_unzz(dpos));
+            d.duty_c = (int16_t)duty;
+            rec->kind = TRACE_SAMPLE;
+            rec->arg = 0;
+        } else {
+            if (d.p >= d.end) return trace_dec_fail(d);
+            uint8_t sub = *d.p++;
+
+            if (sub == 0) {
+                uint32_t pos, duty;
+                if (!trace_get_u32(&d.p, d.end, &pos) || !trace_get_u32(&d.p, d.end, &duty)) {
+                    return trace_dec_fail(d);
+                }
+                int32_t duty_c = trace_unzz(duty);
+                if (duty_c < -32767 || duty_c > 32767) return trace_dec_fail(d);
+
+                // the first sync carries absolute time
+                d.t_last = d.synced ? d.t_last + payload : payload;
+                if (!d.synced) t_prev = d.t_last;
+                d.t_edge = d.t_last;
+                d.iv_edge = 0;
+                d.pos = trace_unzz(pos);
+                d.duty_c = (int16_t)duty_c;
+                d.synced = true;
+                continue;
+            }
+
+            uint32_t dpos;
+            if (!d.synced || sub > TRACE_EV_NUDGE) return trace_dec_fail(d);
+            if (!trace_get_u32(&d.p, d.end, &dpos)) return trace_dec_fail(d);
+
+            d.t_last += payload;
+            d.pos = (int32_t)((uint32_t)d.pos + (uint32_t)trace_unzz(dpos));
+            rec->kind = TRACE_EVENT;
+            rec->arg = sub;
+        }
+
+        rec->dt_us = (uint32_t)(d.t_last - t_prev);
+        rec->pos = d.pos;
+        rec->duty_c = d.duty_c;
+        *t_us = d.t_last;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,349 @@
+#pragma once
+
+// Trace container: FG edges, control samples and events from a mission, in a file that is
+// read in place (memory-mapped) instead of loaded.
+//
+//   TraceHeader                      64 bytes, magic "WTRC", version, where the index is
+//   chunk 0: TraceChunkHeader        t0 (absolute us) + record count
+//            TraceRecord[count]      12 bytes each, time as a delta from the previous record
+//   chunk 1 ...
+//   TraceIndexEntry[chunk_count]     per chunk: time span, position span, file offset
+//
+// Little-endian, fixed-size records, every structure naturally aligned in the file, so a
+// reader can hand out pointers into the mapping (zero copy). Seeking by time is a binary
+// search over the index and a walk of at most one chunk. A file whose writer died has no
+// index (index_offset == 0); trace_view_open rejects it.
+// The format and the reader have no OS dependency; the writer and the file mapping are host
+// only (TRACE_HOST).
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static constexpr uint32_t TRACE_MAGIC      = 0x43525457;   // "WTRC"
+static constexpr uint16_t TRACE_VERSION    = 1;
+static constexpr uint32_t TRACE_CHUNK_MAX  = 4096;         // records per chunk
+
+enum TraceKind : uint8_t {
+    TRACE_EDGE   = 0,   // FG edge; arg = FG level
+    TRACE_SAMPLE = 1,   // control state every loop update
+    TRACE_EVENT  = 2,   // arg = TraceEvent
+};
+
+enum TraceEvent : uint8_t {
+    TRACE_EV_MOVE_START = 1,
+    TRACE_EV_MOVE_END   = 2,
+    TRACE_EV_STALL      = 3,
+    TRACE_EV_TIMEOUT    = 4,
+    TRACE_EV_HOLD_START = 5,
+    TRACE_EV_HOLD_END   = 6,
+    TRACE_EV_NUDGE      = 7,
+};
+
+struct TraceHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint16_t record_size;
+    uint16_t chunk_max;
+    uint32_t unit_id;
+    char     fw_version[16];    // NUL padded
+    uint64_t t_start_us;
+    uint64_t index_offset;      // 0 = not finalised
+    uint32_t chunk_count;
+    uint32_t reserved[3];
+};
+
+struct TraceChunkHeader {
+    uint64_t t0_us;             // absolute time of the first record
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct TraceRecord {
+    uint32_t dt_us;             // since the previous record (first in chunk: since t0_us)
+    int32_t  pos;               // line out, pulses
+    int16_t  duty_c;            // applied duty in 0.01 %, negative = winding in
+    uint8_t  kind;              // TraceKind
+    uint8_t  arg;
+};
+
+struct TraceIndexEntry {
+    uint64_t t_first_us;
+    uint64_t t_last_us;
+    int32_t  pos_min;
+    int32_t  pos_max;
+    uint64_t offset;            // of the TraceChunkHeader
+    uint32_t count;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(TraceHeader) == 64, "trace header layout");
+static_assert(sizeof(TraceChunkHeader) == 16, "trace chunk header layout");
+static_assert(sizeof(TraceRecord) == 12, "trace record layout");
+static_assert(sizeof(TraceIndexEntry) == 40, "trace index layout");
+
+// ---- Reader (over any memory) ----
+
+struct TraceView {
+    const uint8_t*         base;
+    size_t                 size;
+    const TraceHeader*     hdr;
+    const TraceIndexEntry* index;
+};
+
+// Validates the header, the index and every chunk's bounds
+static inline bool trace_view_open(TraceView& v, const void* data, size_t size) {
+    memset(&v, 0, sizeof(v));
+    if (size < sizeof(TraceHeader) || ((uintptr_t)data & 7) != 0) return false;
+
+    const TraceHeader* h = (const TraceHeader*)data;
+    if (h->magic != TRACE_MAGIC || h->version != TRACE_VERSION) return false;
+    if (h->header_size != sizeof(TraceHeader) || h->record_size != sizeof(TraceRecord)) return false;
+    if (h->index_offset == 0 || (h->index_offset & 7) != 0 || h->index_offset > size) return false;
+    if ((uint64_t)h->chunk_count * sizeof(TraceIndexEntry) > size - h->index_offset) return false;
+
+    const TraceIndexEntry* idx = (const TraceIndexEntry*)((const uint8_t*)data + h->index_offset);
+    for (uint32_t i = 0; i < h->chunk_count; i++) {
+        // offset first: a huge one would wrap the end computation back into range
+        if (idx[i].offset < sizeof(TraceHeader) || idx[i].offset > h->index_offset || (idx[i].offset & 7) != 0) return false;
+        if (idx[i].count == 0 || idx[i].count > h->chunk_max) return false;
+        uint64_t end = idx[i].offset + sizeof(TraceChunkHeader) + (uint64_t)idx[i].count * sizeof(TraceRecord);
+        if (end > h->index_offset) return false;
+
+        const TraceChunkHeader* ch = (const TraceChunkHeader*)((const uint8_t*)data + idx[i].offset);
+        if (ch->count != idx[i].count || ch->t0_us != idx[i].t_first_us) return false;
+    }
+
+    v.base  = (const uint8_t*)data;
+    v.size  = size;
+    v.hdr   = h;
+    v.index = idx;
+    return true;
+}
+
+static inline const TraceChunkHeader* trace_chunk(const TraceView& v, uint32_t c) {
+    return (const TraceChunkHeader*)(v.base + v.index[c].offset);
+}
+
+static inline const TraceRecord* trace_chunk_records(const TraceView& v, uint32_t c) {
+    return (const TraceRecord*)(v.base + v.index[c].offset + sizeof(TraceChunkHeader));
+}
+
+// First chunk whose span ends at or after t (chunk_count if none)
+static inline uint32_t trace_find_chunk(const TraceView& v, uint64_t t_us) {
+    uint32_t lo = 0, hi = v.hdr->chunk_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (v.index[mid].t_last_us < t_us) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+struct TraceCursor {
+    const TraceView* v;
+    uint32_t chunk;
+    uint32_t i;          // next record in the chunk
+    uint64_t t_us;       // time of the last record returned
+};
+
+static inline void trace_rewind(TraceCursor& c, const TraceView& v) {
+    c.v = &v;
+    c.chunk = 0;
+    c.i = 0;
+    c.t_us = (v.hdr->chunk_count > 0) ? v.index[0].t_first_us : 0;
+}
+
+// Next record in time order, pointing into the trace; false at the end
+static inline bool trace_next(TraceCursor& c, const TraceRecord** rec, uint64_t* t_us) {
+    const TraceView& v = *c.v;
+    while (c.chunk < v.hdr->chunk_count && c.i >= v.index[c.chunk].count) {
+        c.chunk++;
+        c.i = 0;
+    }
+    if (c.chunk >= v.hdr->chunk_count) return false;
+
+    if (c.i == 0) c.t_us = trace_chunk(v, c.chunk)->t0_us;
+    const TraceRecord* r = &trace_chunk_records(v, c.chunk)[c.i++];
+    c.t_us += r->dt_us;
+
+    *rec = r;
+    *t_us = c.t_us;
+    return true;
+}
+
+// Position the cursor so the next trace_next returns the first record at or after t
+static inline void trace_seek(TraceCursor& c, const TraceView& v, uint64_t t_us) {
+    c.v = &v;
+    c.chunk = trace_find_chunk(v, t_us);
+    c.i = 0;
+    if (c.chunk >= v.hdr->chunk_count) return;
+
+    const TraceRecord* r = trace_chunk_records(v, c.chunk);
+    uint64_t t = trace_chunk(v, c.chunk)->t0_us;
+    uint32_t n = v.index[c.chunk].count;
+
+    while (c.i < n && t + r[c.i].dt_us < t_us) {
+        t += r[c.i].dt_us;
+        c.i++;
+    }
+    c.t_us = t;
+}
+
+// ---- Writer and file mapping (host) ----
+
+#ifndef TRACE_HOST
+#if defined(__unix__) || defined(__APPLE__)
+#define TRACE_HOST 1
+#else
+#define TRACE_HOST 0
+#endif
+#endif
+
+#if TRACE_HOST
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+struct TraceWriter {
+    FILE*                        f;
+    TraceHeader                  hdr;
+    TraceChunkHeader             ch;
+    TraceRecord                  buf[TRACE_CHUNK_MAX];
+    TraceIndexEntry              cur;
+    uint64_t                     t_last_us;
+    uint64_t                     offset;
+    std::vector<TraceIndexEntry> index;
+};
+
+static inline bool trace_writer_open(TraceWriter& w, const char* path, uint32_t unit_id,
+                                     const char* fw_version, uint64_t t_start_us) {
+    w.f = fopen(path, "wb");
+    if (!w.f) return false;
+
+    memset(&w.hdr, 0, sizeof(w.hdr));
+    w.hdr.magic       = TRACE_MAGIC;
+    w.hdr.version     = TRACE_VERSION;
+    w.hdr.header_size = sizeof(TraceHeader);
+    w.hdr.record_size = sizeof(TraceRecord);
+    w.hdr.chunk_max   = (uint16_t)TRACE_CHUNK_MAX;
+    w.hdr.unit_id     = unit_id;
+    w.hdr.t_start_us  = t_start_us;
+    strncpy(w.hdr.fw_version, fw_version, sizeof(w.hdr.fw_version) - 1);
+
+    w.ch.count = 0;
+    w.t_last_us = t_start_us;
+    w.offset = sizeof(TraceHeader);
+    w.index.clear();
+    return fwrite(&w.hdr, sizeof(w.hdr), 1, w.f) == 1;
+}
+
+static inline bool trace_writer_flush_chunk(TraceWriter& w) {
+    if (w.ch.count == 0) return true;
+
+    w.cur.offset = w.offset;
+    w.cur.count = w.ch.count;
+    w.cur.reserved = 0;
+    w.index.push_back(w.cur);
+
+    size_t n = w.ch.count;
+    bool ok = fwrite(&w.ch, sizeof(w.ch), 1, w.f) == 1 && fwrite(w.buf, sizeof(TraceRecord), n, w.f) == n;
+    w.offset += sizeof(w.ch) + n * sizeof(TraceRecord);
+
+    // keep the next chunk header 8-aligned
+    static const uint8_t pad[8] = {0};
+    size_t p = (size_t)((8 - (w.offset & 7)) & 7);
+    if (p) ok = ok && fwrite(pad, 1, p, w.f) == p;
+    w.offset += p;
+
+    w.ch.count = 0;
+    return ok;
+}
+
+// Records must come in time order
+static inline bool trace_write(TraceWriter& w, uint64_t t_us, TraceKind kind, uint8_t arg,
+                               int32_t pos, float duty_pct) {
+    if (t_us < w.t_last_us) t_us = w.t_last_us;
+
+    bool ok = true;
+    if (w.ch.count >= w.hdr.chunk_max || (w.ch.count > 0 && t_us - w.t_last_us > 0xFFFFFFFFull)) {
+        ok = trace_writer_flush_chunk(w);
+    }
+
+    TraceRecord& r = w.buf[w.ch.count];
+    if (w.ch.count == 0) {
+        w.ch.t0_us = t_us;
+        w.ch.reserved = 0;
+        w.cur.t_first_us = t_us;
+        w.cur.pos_min = w.cur.pos_max = pos;
+        r.dt_us = 0;
+    } else {
+        r.dt_us = (uint32_t)(t_us - w.t_last_us);
+    }
+
+    float c = duty_pct * 100.0f;
+    r.pos    = pos;
+    r.duty_c = (int16_t)(c > 32767.0f ? 32767.0f : (c < -32767.0f ? -32767.0f : c));
+    r.kind   = kind;
+    r.arg    = arg;
+
+    if (pos < w.cur.pos_min) w.cur.pos_min = pos;
+    if (pos > w.cur.pos_max) w.cur.pos_max = pos;
+    w.cur.t_last_us = t_us;
+    w.t_last_us = t_us;
+    w.ch.count++;
+    return ok;
+}
+
+// Writes the index and patches the header; the file is readable only after this
+static inline bool trace_writer_close(TraceWriter& w) {
+    bool ok = trace_writer_flush_chunk(w);
+
+    w.hdr.index_offset = w.offset;
+    w.hdr.chunk_count = (uint32_t)w.index.size();
+    size_t n = w.index.size();
+    ok = ok && fwrite(w.index.data(), sizeof(TraceIndexEntry), n, w.f) == n;
+    ok = ok && fseek(w.f, 0, SEEK_SET) == 0 && fwrite(&w.hdr, sizeof(w.hdr), 1, w.f) == 1;
+    ok = (fclose(w.f) == 0) && ok;
+    w.f = nullptr;
+    return ok;
+}
+
+struct TraceMap {
+    void*     data;
+    size_t    size;
+    TraceView view;
+};
+
+static inline bool trace_map_open(TraceMap& m, const char* path) {
+    m.data = nullptr;
+    m.size = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+
+    m.size = (size_t)st.st_size;
+    m.data = mmap(nullptr, m.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m.data == MAP_FAILED) { m.data = nullptr; return false; }
+
+    if (!trace_view_open(m.view, m.data, m.size)) {
+        munmap(m.data, m.size);
+        m.data = nullptr;
+        return false;
+    }
+    return true;
+}
+
+static inline void trace_map_close(TraceMap& m) {
+    if (m.data) munmap(m.data, m.size);
+    m.data = nullptr;
+}
+#endif
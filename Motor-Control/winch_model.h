@@ -0,0 +1,49 @@
+#pragma once
+
+// First-order model of motor + gearbox + drum, as seen through the FG pulses.
+// No hardware access here: the same code runs in the firmware (tuning sim) and on a host.
+
+#include <math.h>
+#include <stdint.h>
+
+// Steady-state drum speed is gain * (duty - deadzone); speed follows with time constant tau.
+struct PlantParams {
+    float gain_pps_per_pct;   // FG pulses/s per % duty above the deadzone
+    float tau_s;              // mechanical time constant (motor + payload inertia)
+    float deadzone_pct;       // duty below which the drum does not turn
+    float pulses_per_meter;   // line out per FG pulse (drum geometry)
+};
+
+struct PlantState {
+    float speed_pps;   // FG pulses per second
+    float pos_pulses;  // line paid out / taken in, in FG pulses
+};
+
+// Datasheet-derived starting point: rated speed at 100 % duty (570 RPM, 14:1, 6 FG/rev ≈ 8 pps per %)
+static inline PlantParams plant_default_params(float full_speed_pps, float pulses_per_meter) {
+    PlantParams p;
+    p.gain_pps_per_pct = full_speed_pps / 100.0f;
+    p.tau_s            = 0.08f;
+    p.deadzone_pct     = 5.0f;
+    p.pulses_per_meter = pulses_per_meter;
+    return p;
+}
+
+static inline bool plant_params_sane(const PlantParams& p) {
+    return p.gain_pps_per_pct > 0.0f && p.gain_pps_per_pct < 1000.0f &&
+           p.tau_s > 0.001f && p.tau_s < 2.0f &&
+           p.deadzone_pct >= 0.0f && p.deadzone_pct < 50.0f &&
+           p.pulses_per_meter > 0.0f;
+}
+
+// Advance the plant by dt (implicit Euler, stable for any dt)
+static inline void plant_step(PlantState& s, const PlantParams& p, float duty_pct, float dt_s) {
+    float eff = duty_pct - p.deadzone_pct;
+    if (eff < 0) eff = 0;
+
+    float ss = p.gain_pps_per_pct * eff;
+    float a  = dt_s / (p.tau_s + dt_s);
+
+    s.speed_pps  += (ss - s.speed_pps) * a;
+    s.pos_pulses += s.speed_pps * dt_s;
+}
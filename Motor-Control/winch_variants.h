@@ -0,0 +1,64 @@
+#pragma once
+
+// Catalogue of motor / gearbox / drum variants we field.
+// Pick one at build time (-DWINCH_VARIANT=<index>, see CMakeLists.txt) or at runtime with
+// "param set variant <index>" + save; the choice is read once at boot and every derived
+// constant is computed from it there. No hardware access here.
+
+#include <math.h>
+#include <stdint.h>
+
+enum WinchVariantId : uint32_t {
+    WINCH_24V_570RPM_14_D50 = 0,   // original unit: 24V 570RPM version (14:1), 50 mm drum
+    WINCH_24V_285RPM_28_D50 = 1,   // heavy lift: same motor, 28:1 gearbox
+    WINCH_24V_570RPM_14_D80 = 2,   // long line: 80 mm drum, faster line speed
+    WINCH_12V_330RPM_27_D40 = 3,   // small airframe: 12V motor, 40 mm drum
+    WINCH_VARIANT_COUNT
+};
+
+#ifndef WINCH_VARIANT
+#define WINCH_VARIANT WINCH_24V_570RPM_14_D50
+#endif
+
+struct WinchVariant {
+    const char* name;
+    float    rated_rpm;                // output shaft at 100 % duty, rated voltage
+    float    gear_ratio;
+    uint32_t fg_pulses_per_motor_rev;
+    float    drum_diameter_m;
+    float    max_line_m;               // line the drum holds
+    float    safe_slew_rate;           // %/s default for speed changes
+    float    safe_brake_rate;          // %/s default for brake_to_stop
+    float    max_duty_pct;             // duty cap keeping stall current inside the driver rating
+    float    supply_v;                 // motor supply at 100 % duty
+    float    winding_ohm;              // terminal resistance (datasheet), for the energy model
+};
+
+static const WinchVariant WINCH_VARIANTS[WINCH_VARIANT_COUNT] = {
+    // name                 rpm     ratio  fg  drum    line   slew    brake   duty    volt   ohm
+    { "24V-570RPM-14:1-D50", 570.0f, 14.0f, 6, 0.050f, 10.0f, 200.0f, 400.0f, 100.0f, 24.0f, 4.0f },
+    { "24V-285RPM-28:1-D50", 285.0f, 28.0f, 6, 0.050f, 10.0f, 150.0f, 300.0f, 100.0f, 24.0f, 4.0f },
+    { "24V-570RPM-14:1-D80", 570.0f, 14.0f, 6, 0.080f, 25.0f, 150.0f, 300.0f,  90.0f, 24.0f, 4.0f },
+    { "12V-330RPM-27:1-D40", 330.0f, 27.0f, 6, 0.040f,  6.0f, 250.0f, 500.0f,  85.0f, 12.0f, 2.2f },
+};
+
+// Everything the firmware needs from the variant, computed once
+struct WinchDerived {
+    const WinchVariant* v;
+    float pulses_per_drum_rev;   // gear_ratio * pulses_per_motor_rev
+    float pulses_per_meter;      // pulses_per_drum_rev / (pi * D)
+    float full_speed_pps;        // FG pulses/s at rated rpm
+    float max_line_speed_mps;    // line speed at rated rpm
+};
+
+static inline WinchDerived winch_derive(uint32_t variant) {
+    if (variant >= WINCH_VARIANT_COUNT) variant = WINCH_VARIANT;
+
+    WinchDerived d;
+    d.v = &WINCH_VARIANTS[variant];
+    d.pulses_per_drum_rev = d.v->gear_ratio * (float)d.v->fg_pulses_per_motor_rev;
+    d.pulses_per_meter    = d.pulses_per_drum_rev / ((float)M_PI * d.v->drum_diameter_m);
+    d.full_speed_pps      = d.v->rated_rpm / 60.0f * d.pulses_per_drum_rev;
+    d.max_line_speed_mps  = d.full_speed_pps / d.pulses_per_meter;
+    return d;
+}